@@ -0,0 +1,310 @@
+/*
+ * Enna Media Center
+ * Copyright (C) 2005-2013 Enna Team. All rights reserved.
+ *
+ * This file is part of Enna.
+ *
+ * Enna is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Enna is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Enna; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+
+/*
+ * Covers and fanarts are downloaded by the grabbers at whatever size the
+ * provider serves, often several megapixels. The views only ever show them
+ * in a few slots, so a derivative is rendered once per size class, saved
+ * next to the originals and reused from then on.
+ *
+ * Evas is not thread safe: derivatives are rendered from an idler on a
+ * private buffer canvas, one image per idle iteration.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+
+#include <Eina.h>
+#include <Ecore.h>
+#include <Ecore_Evas.h>
+#include <Ecore_File.h>
+
+#include "enna.h"
+#include "logs.h"
+#include "utils.h"
+#include "artwork.h"
+
+#define MODULE_NAME "artwork"
+
+#define PATH_ARTWORK      "artwork"
+#define ARTWORK_QUALITY   "quality=90"
+/* used for the backdrops when the window size is not known yet */
+#define ARTWORK_SCREEN_W  1280
+#define ARTWORK_SCREEN_H  720
+
+typedef struct _Artwork_Class Artwork_Class;
+typedef struct _Artwork_Job Artwork_Job;
+
+struct _Artwork_Class
+{
+    const char *name;
+    int w;
+    int h;
+};
+
+struct _Artwork_Job
+{
+    const char *original;
+    const char *path;
+    int w;
+    int h;
+};
+
+/* bounding boxes, 0 means the screen size */
+static const Artwork_Class artwork_classes[ENNA_ARTWORK_SIZE_LAST] = {
+    { "icon",     128, 128 },
+    { "panel",    480, 480 },
+    { "backdrop",   0,   0 },
+};
+
+static Eina_List *jobs = NULL;
+static Eina_Hash *pending = NULL;
+static Eina_Hash *failed = NULL;
+static Ecore_Idler *idler = NULL;
+
+static void
+_class_size_get(Enna_Artwork_Size size, int *w, int *h)
+{
+    *w = artwork_classes[size].w;
+    *h = artwork_classes[size].h;
+    if (*w && *h)
+        return;
+
+    *w = *h = 0;
+    if (enna && enna->win)
+        evas_object_geometry_get(enna->win, NULL, NULL, w, h);
+    if (*w <= 0 || *h <= 0)
+    {
+        *w = ARTWORK_SCREEN_W;
+        *h = ARTWORK_SCREEN_H;
+    }
+}
+
+static void
+_job_free(Artwork_Job *job)
+{
+    eina_stringshare_del(job->original);
+    eina_stringshare_del(job->path);
+    free(job);
+}
+
+static Eina_Bool
+_artwork_render(Artwork_Job *job)
+{
+    Ecore_Evas *ee;
+    Evas *evas;
+    Evas_Object *im;
+    int iw = 0, ih = 0, ww, hh;
+    Eina_Bool ret = EINA_FALSE;
+
+    ee = ecore_evas_buffer_new(1, 1);
+    if (!ee)
+        return EINA_FALSE;
+    evas = ecore_evas_get(ee);
+    evas_image_cache_set(evas, 0);
+
+    /* let the loader decode at a reduced scale when it can (jpeg) */
+    im = evas_object_image_add(evas);
+    evas_object_image_load_size_set(im, job->w, job->h);
+    evas_object_image_file_set(im, job->original, NULL);
+    evas_object_image_size_get(im, &iw, &ih);
+    if (iw <= 0 || ih <= 0)
+        goto end;
+
+    /* fit in the class box, never upscale */
+    ww = job->w;
+    hh = (job->w * ih) / iw;
+    if (hh > job->h)
+    {
+        hh = job->h;
+        ww = (job->h * iw) / ih;
+    }
+    if (ww > iw || hh > ih)
+    {
+        ww = iw;
+        hh = ih;
+    }
+    if (ww <= 0 || hh <= 0)
+        goto end;
+
+    evas_object_image_smooth_scale_set(im, EINA_TRUE);
+    evas_object_image_fill_set(im, 0, 0, ww, hh);
+    evas_object_move(im, 0, 0);
+    evas_object_resize(im, ww, hh);
+    evas_object_show(im);
+    ecore_evas_resize(ee, ww, hh);
+
+    ret = enna_util_canvas_save(ee, job->path, ARTWORK_QUALITY);
+
+ end:
+    /* will free all */
+    ecore_evas_free(ee);
+    return ret;
+}
+
+static Eina_Bool
+_artwork_idler_cb(void *data EINA_UNUSED)
+{
+    Artwork_Job *job;
+    double t0;
+
+    job = eina_list_data_get(jobs);
+    if (!job)
+    {
+        idler = NULL;
+        return ECORE_CALLBACK_CANCEL;
+    }
+    jobs = eina_list_remove_list(jobs, jobs);
+    eina_hash_del_by_key(pending, job->path);
+
+    t0 = ecore_time_get();
+    if (_artwork_render(job))
+        enna_log(ENNA_MSG_EVENT, MODULE_NAME, "%s (%dx%d) in %.1f ms",
+                 job->path, job->w, job->h,
+                 (ecore_time_get() - t0) * 1000.0);
+    else
+    {
+        enna_log(ENNA_MSG_WARNING, MODULE_NAME,
+                 "unable to render a derivative of %s", job->original);
+        /* do not try again for every lookup */
+        eina_hash_set(failed, job->original, (void *) EINA_TRUE);
+    }
+    _job_free(job);
+
+    if (jobs)
+        return ECORE_CALLBACK_RENEW;
+
+    idler = NULL;
+    return ECORE_CALLBACK_CANCEL;
+}
+
+static void
+_artwork_queue(const char *original, const char *path, int w, int h)
+{
+    Artwork_Job *job;
+    char *dir;
+
+    if (eina_hash_find(pending, path) || eina_hash_find(failed, original))
+        return;
+
+    dir = ecore_file_dir_get(path);
+    if (dir && !ecore_file_is_dir(dir))
+        ecore_file_mkpath(dir);
+    free(dir);
+
+    job = calloc(1, sizeof(Artwork_Job));
+    if (!job)
+        return;
+    job->original = eina_stringshare_add(original);
+    job->path = eina_stringshare_add(path);
+    job->w = w;
+    job->h = h;
+
+    eina_hash_add(pending, job->path, job);
+    jobs = eina_list_append(jobs, job);
+    if (!idler)
+        idler = ecore_idler_add(_artwork_idler_cb, NULL);
+}
+
+/* Fill path with the derivative of original and tell whether it is up to
+ * date, a missing or stale one is queued for generation. */
+static Eina_Bool
+_artwork_lookup(const char *original, Enna_Artwork_Size size,
+                char *path, size_t len)
+{
+    long long mtime;
+    int w, h;
+
+    if (!pending || !original || size >= ENNA_ARTWORK_SIZE_LAST)
+        return EINA_FALSE;
+
+    /* remote or missing original, nothing to derive from */
+    mtime = ecore_file_mod_time(original);
+    if (!mtime)
+        return EINA_FALSE;
+
+    _class_size_get(size, &w, &h);
+    snprintf(path, len, "%s/%s/%s-%dx%d/%016llx.jpg",
+             enna_util_data_home_get(), PATH_ARTWORK,
+             artwork_classes[size].name, w, h,
+             (unsigned long long) enna_util_str_hash(original));
+
+    if (ecore_file_mod_time(path) >= mtime)
+        return EINA_TRUE;
+
+    _artwork_queue(original, path, w, h);
+    return EINA_FALSE;
+}
+
+void
+enna_artwork_generate(const char *original, Enna_Artwork_Size size)
+{
+    char path[PATH_MAX];
+
+    _artwork_lookup(original, size, path, sizeof(path));
+}
+
+const char *
+enna_artwork_get(const char *original, Enna_Artwork_Size size)
+{
+    char path[PATH_MAX];
+
+    if (!original)
+        return NULL;
+
+    if (_artwork_lookup(original, size, path, sizeof(path)))
+        return eina_stringshare_add(path);
+
+    return eina_stringshare_add(original);
+}
+
+int
+enna_artwork_init(void)
+{
+    pending = eina_hash_string_superfast_new(NULL);
+    failed = eina_hash_string_superfast_new(NULL);
+
+    return 1;
+}
+
+void
+enna_artwork_shutdown(void)
+{
+    Artwork_Job *job;
+
+    if (idler)
+        ecore_idler_del(idler);
+    idler = NULL;
+
+    EINA_LIST_FREE(jobs, job)
+        _job_free(job);
+
+    if (pending)
+        eina_hash_free(pending);
+    pending = NULL;
+    if (failed)
+        eina_hash_free(failed);
+    failed = NULL;
+}
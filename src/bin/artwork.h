@@ -0,0 +1,47 @@
+/*
+ * GeeXboX Enna Media Center.
+ * Copyright (C) 2005-2010 The Enna Project
+ *
+ * This file is part of Enna.
+ *
+ * Enna is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Enna is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Enna; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+
+#ifndef ARTWORK_H
+#define ARTWORK_H
+
+/* Fixed size classes of the derivatives generated from downloaded covers
+ * and fanarts, the views ask for the class matching their slot instead of
+ * decoding the original. */
+typedef enum _Enna_Artwork_Size
+{
+    ENNA_ARTWORK_ICON,     /* list and OSD icons */
+    ENNA_ARTWORK_PANEL,    /* information panels */
+    ENNA_ARTWORK_BACKDROP, /* full screen backdrops, at screen height */
+    ENNA_ARTWORK_SIZE_LAST
+} Enna_Artwork_Size;
+
+int enna_artwork_init(void);
+void enna_artwork_shutdown(void);
+
+/* Queue the generation of a derivative unless an up to date one exists */
+void enna_artwork_generate(const char *original, Enna_Artwork_Size size);
+
+/* Path (stringshare) of the derivative of original, or of original itself
+ * while the derivative is not generated yet (it is queued then). */
+const char *enna_artwork_get(const char *original, Enna_Artwork_Size size);
+
+#endif /* ARTWORK_H */
@@ -30,6 +30,7 @@
 #include "buffer.h"
 #include "logs.h"
 #include "utils.h"
+#include "trace.h"
 #include "vfs.h"
 
 typedef enum _Enna_Browser_Type
@@ -54,6 +55,10 @@ struct _Enna_Browser
     Ecore_Event_Handler *ev_handler;
     Eina_List *tokens;
     Eina_List* files;
+    /* the playable files of files, handed to the playlists as is */
+    Enna_File_Array *media;
+    int counts[ENNA_BROWSER_COUNT_LAST];
+    Enna_File_Arena *arena;
     Enna_Vfs_Class *vfs;
 };
 
@@ -65,6 +70,8 @@ static Eina_Bool
 _add_idler(void *data)
 {
     Enna_Browser* b = data;
+
+    ENNA_TRACE_BEGIN("browser/add_idler");
     switch (b->type)
     {
     case BROWSER_ROOT:
@@ -81,6 +88,7 @@ _add_idler(void *data)
 
     }
     b->queue_idler = NULL;
+    ENNA_TRACE_END("browser/add_idler");
     return EINA_FALSE;
 
 }
@@ -150,13 +158,26 @@ enna_browser_del(Enna_Browser *b)
         ecore_event_handler_del(b->ev_handler);
     EINA_LIST_FREE(b->files, file)
         enna_file_free(file);
+    enna_file_array_unref(b->media);
     EINA_LIST_FREE(b->tokens, token)
         free(token);
     if (b->vfs)
         b->vfs->func.del(b->priv_module);
+    enna_file_arena_release(b->arena);
     free(b);
 }
 
+Enna_File_Arena *
+enna_browser_arena_get(Enna_Browser *b)
+{
+    if (!b)
+        return NULL;
+
+    if (!b->arena)
+        b->arena = enna_file_arena_new();
+    return b->arena;
+}
+
 void
 enna_browser_browse(Enna_Browser *b)
 {
@@ -183,18 +204,18 @@ _browser_browse_root(Enna_Browser *browser)
 {
     Eina_List *l;
     Enna_Class_Activity *act;
-    Enna_Buffer *buf;
+    Enna_Buffer buf;
     Enna_File *f;
 
+    enna_buffer_init(&buf);
     EINA_LIST_FOREACH(enna_activities_get(), l, act)
     {
         f = calloc(1, sizeof(Enna_File));
 
-        buf = enna_buffer_new();
-        enna_buffer_appendf(buf, "/%s", act->name);
+        enna_buffer_reset(&buf);
+        enna_buffer_appendf(&buf, "/%s", act->name);
         f->name = eina_stringshare_add(act->name);
-        f->uri = eina_stringshare_add(buf->buf);
-        enna_buffer_free(buf);
+        f->uri = eina_stringshare_add(buf.buf);
         f->label = eina_stringshare_add(act->label);
         f->icon = eina_stringshare_add(act->icon);
         f->icon_file = eina_stringshare_add(act->bg);
@@ -205,6 +226,7 @@ _browser_browse_root(Enna_Browser *browser)
             browser->add(browser->add_data, f);
 
     }
+    enna_buffer_release(&buf);
 }
 
 static void
@@ -217,18 +239,18 @@ _browser_browse_activity(Enna_Browser *browser)
     Enna_Vfs_Class *vfs;
     Eina_List *l;
     Enna_File *f;
-    Enna_Buffer *buf;
+    Enna_Buffer buf;
 
+    enna_buffer_init(&buf);
     EINA_LIST_FOREACH(enna_vfs_get(act->caps), l, vfs)
     {
 
         f = calloc(1, sizeof(Enna_File));
 
-        buf = enna_buffer_new();
-        enna_buffer_appendf(buf, "/%s/%s", act_name, vfs->name);
+        enna_buffer_reset(&buf);
+        enna_buffer_appendf(&buf, "/%s/%s", act_name, vfs->name);
         f->name = eina_stringshare_add(vfs->name);
-        f->uri = eina_stringshare_add(buf->buf);
-        enna_buffer_free(buf);
+        f->uri = eina_stringshare_add(buf.buf);
         f->label = eina_stringshare_add(vfs->label);
         f->icon = eina_stringshare_add(vfs->icon);
         f->type = ENNA_FILE_MENU;
@@ -236,6 +258,56 @@ _browser_browse_activity(Enna_Browser *browser)
         if (browser->add)
             browser->add(browser->add_data, f);
     }
+    enna_buffer_release(&buf);
+}
+
+static void
+_count_update(Enna_Browser *b, Enna_File *file, int delta)
+{
+    if (ENNA_FILE_IS_BROWSABLE(file))
+    {
+        b->counts[ENNA_BROWSER_COUNT_DIRS] += delta;
+        return;
+    }
+
+    b->counts[ENNA_BROWSER_COUNT_FILES] += delta;
+    if (file->type == ENNA_FILE_TRACK)
+        b->counts[ENNA_BROWSER_COUNT_TRACKS] += delta;
+    else if (file->type == ENNA_FILE_FILM)
+        b->counts[ENNA_BROWSER_COUNT_FILMS] += delta;
+}
+
+static void
+_media_add(Enna_Browser *b, Enna_File *file)
+{
+    Enna_File_Array *media;
+
+    if (ENNA_FILE_IS_BROWSABLE(file))
+        return;
+
+    /* a playlist may still be playing the previous content */
+    media = b->media ? enna_file_array_own(b->media) : enna_file_array_new();
+    if (!media)
+        return;
+    b->media = media;
+    enna_file_array_append(b->media, file);
+}
+
+static void
+_media_del(Enna_Browser *b, Enna_File *file)
+{
+    Enna_File_Array *media;
+    int i;
+
+    i = enna_file_array_index_get(b->media, file);
+    if (i < 0)
+        return;
+
+    media = enna_file_array_own(b->media);
+    if (!media)
+        return;
+    b->media = media;
+    enna_file_array_remove(b->media, i);
 }
 
 void
@@ -258,6 +330,8 @@ enna_browser_file_add(Enna_Browser *b, Enna_File *file)
     }
 
     b->files = eina_list_append(b->files, file);
+    _count_update(b, file, 1);
+    _media_add(b, file);
     b->add(b->add_data, file);
 }
 
@@ -279,16 +353,12 @@ enna_browser_file_update(Enna_Browser *b, Enna_File *file)
     {
         EINA_LIST_FOREACH(b->files, l, f)
         {
-            if(!strcmp(f->uri, file->uri))
+            if(!strcmp(enna_file_uri_get(f), enna_file_uri_get(file)))
             {
-                eina_stringshare_replace(&f->name, file->name);
-                eina_stringshare_replace(&f->label, file->label);
-                eina_stringshare_replace(&f->icon, file->icon);
-                eina_stringshare_replace(&f->icon_file, file->icon_file);
-                eina_stringshare_replace(&f->mrl, file->mrl);
-                f->type = file->type;
-                f->meta_class = file->meta_class;
-                f->meta_data = file->meta_data;
+                /* the type may change */
+                _count_update(b, f, -1);
+                enna_file_update(f, file);
+                _count_update(b, f, 1);
                 b->update(b->update_data, f);
                 enna_file_free(file);
                 return f;
@@ -307,7 +377,12 @@ enna_browser_file_del(Enna_Browser *b, Enna_File *file)
     if (!b || !file)
         return;
 
+    if (!eina_list_data_find(b->files, file))
+        return;
+
     b->files = eina_list_remove(b->files, file);
+    _count_update(b, file, -1);
+    _media_del(b, file);
     b->del(b->del_data, file);
 }
 
@@ -348,6 +423,21 @@ enna_browser_files_get(Enna_Browser *b)
     return b ? b->files : NULL;
 }
 
+Enna_File_Array *
+enna_browser_media_get(Enna_Browser *b)
+{
+    return b ? b->media : NULL;
+}
+
+int
+enna_browser_count_get(Enna_Browser *b, Enna_Browser_Count count)
+{
+    if (!b || count >= ENNA_BROWSER_COUNT_LAST)
+        return 0;
+
+    return b->counts[count];
+}
+
 const char *
 enna_browser_uri_get(Enna_Browser *b)
 {
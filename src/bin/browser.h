@@ -27,6 +27,16 @@
 
 typedef struct _Enna_Browser Enna_Browser;
 
+/* Entries of the listing by kind, kept up to date as files come and go */
+typedef enum _Enna_Browser_Count
+{
+    ENNA_BROWSER_COUNT_DIRS,   /* browsable entries */
+    ENNA_BROWSER_COUNT_FILES,  /* all the other ones, including: */
+    ENNA_BROWSER_COUNT_TRACKS,
+    ENNA_BROWSER_COUNT_FILMS,
+    ENNA_BROWSER_COUNT_LAST
+} Enna_Browser_Count;
+
 Enna_Browser *enna_browser_add(void (*add)(void *data, Enna_File *file), void *add_data,
                                void (*del)(void *data, Enna_File *file), void *del_data,
                                void (*update)(void *data, Enna_File *file), void *update_data,
@@ -39,6 +49,12 @@ Enna_File *enna_browser_file_update(Enna_Browser *b, Enna_File *file);
 Enna_File *enna_browser_get_file(const char *uri);
 const char *enna_browser_uri_get(Enna_Browser *b);
 Eina_List *enna_browser_files_get(Enna_Browser *b);
+/* Playable files of the listing in order, take a reference with
+ * enna_file_array_ref() to keep them past the browser. */
+Enna_File_Array *enna_browser_media_get(Enna_Browser *b);
+int enna_browser_count_get(Enna_Browser *b, Enna_Browser_Count count);
+/* Arena for the files of the listing, released with the browser */
+Enna_File_Arena *enna_browser_arena_get(Enna_Browser *b);
 int enna_browser_level_get(Enna_Browser *b);
 void enna_browser_filter(Enna_Browser *b, const char *filter);
 #endif /* BROWSER_H */
@@ -324,7 +324,7 @@ _browse(Smart_Data *sd, Enna_File *file, Eina_Bool back)
         sd->visited = eina_list_append(sd->visited, enna_file_ref(file));
     enna_browser_del(sd->browser);
 
-    sd->browser = enna_browser_add(_add_cb, sd, _del_cb, sd, _update_cb, sd, file->uri);
+    sd->browser = enna_browser_add(_add_cb, sd, _del_cb, sd, _update_cb, sd, enna_file_uri_get(file));
 
     ENNA_OBJECT_DEL(sd->o_view);
 
@@ -332,7 +332,7 @@ _browse(Smart_Data *sd, Enna_File *file, Eina_Bool back)
         ecore_timer_del(sd->hilight_timer);
     sd->hilight_timer = NULL;
     sd->o_view = NULL;
-    DBG("browse uri : %s", file->uri);
+    DBG("browse uri : %s", enna_file_uri_get(file));
 
     enna_browser_browse(sd->browser);
 }
@@ -345,7 +345,7 @@ _browse_back(Smart_Data *sd)
 
     cur = (Enna_File*)eina_list_nth(sd->visited,
                                      eina_list_count(sd->visited) - 1);
-    if (!cur || cur->uri == sd->root_uri)
+    if (!cur || enna_file_uri_get(cur) == sd->root_uri)
         evas_object_smart_callback_call (sd->o_layout, "root", NULL);
 
     sd->prev = cur;
@@ -361,7 +361,7 @@ _browse_back(Smart_Data *sd)
 
     _browse(sd, prev, EINA_TRUE);
 
-    DBG("Browse Back %s| root is %s", prev->uri, sd->root->uri);
+    DBG("Browse Back %s| root is %s", enna_file_uri_get(prev), enna_file_uri_get(sd->root));
 
 
 }
@@ -377,6 +377,22 @@ enna_browser_obj_files_get(Evas_Object *obj)
         enna_browser_files_get(sd->browser);
 }
 
+Enna_File_Array *
+enna_browser_obj_media_get(Evas_Object *obj)
+{
+    Smart_Data *sd = evas_object_data_get(obj, "sd");
+
+    return sd->browser ? enna_browser_media_get(sd->browser) : NULL;
+}
+
+int
+enna_browser_obj_count_get(Evas_Object *obj, Enna_Browser_Count count)
+{
+    Smart_Data *sd = evas_object_data_get(obj, "sd");
+
+    return enna_browser_count_get(sd->browser, count);
+}
+
 static Eina_Bool
 _view_event(Smart_Data *sd, enna_input event)
 {
@@ -25,6 +25,8 @@
 
 #include <Elementary.h>
 
+#include "browser.h"
+
 typedef enum _Enna_Browser_View_Type
 {
     ENNA_BROWSER_VIEW_LIST,
@@ -37,5 +39,7 @@ void enna_browser_obj_root_set(Evas_Object *obj, const char *uri);
 void enna_browser_obj_view_type_set(Evas_Object *obj, Enna_Browser_View_Type view_type);
 void enna_browser_obj_input_feed(Evas_Object *obj, enna_input event);
 Eina_List *enna_browser_obj_files_get(Evas_Object *obj);
+Enna_File_Array *enna_browser_obj_media_get(Evas_Object *obj);
+int enna_browser_obj_count_get(Evas_Object *obj, Enna_Browser_Count count);
 
 #endif /* BROWSER_OBJ_H */
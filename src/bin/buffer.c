@@ -23,7 +23,6 @@
 #include <stdlib.h>
 #include <stdarg.h>
 #include <string.h>
-#include <limits.h>
 
 #include "buffer.h"
 
@@ -31,8 +30,6 @@
 #define MAX(a,b) ((a) > (b) ? (a) : (b))
 #endif
 
-#define BUFFER_DEFAULT_CAPACITY 32768
-
 Enna_Buffer *
 enna_buffer_new(void)
 {
@@ -40,61 +37,147 @@ enna_buffer_new(void)
 }
 
 void
-enna_buffer_append(Enna_Buffer *buffer, const char *str)
+enna_buffer_init(Enna_Buffer *buffer)
 {
-    size_t len;
+    if (!buffer)
+        return;
 
-    if (!buffer || !str)
+    buffer->buf = NULL;
+    buffer->len = 0;
+    buffer->capacity = 0;
+}
+
+void
+enna_buffer_reset(Enna_Buffer *buffer)
+{
+    if (!buffer || !buffer->buf)
         return;
 
-    if (!buffer->buf)
+    buffer->len = 0;
+    buffer->buf[0] = '\0';
+}
+
+/* make room for len more bytes plus the terminating nul */
+static int
+_buffer_grow(Enna_Buffer *buffer, size_t len)
+{
+    size_t needed;
+    char *tmp;
+
+    needed = buffer->len + len + 1;
+    if (buffer->buf && needed <= buffer->capacity)
+        return 1;
+
+    if (!buffer->buf && needed <= ENNA_BUFFER_INLINE_SIZE)
     {
-        buffer->capacity = BUFFER_DEFAULT_CAPACITY;
-        buffer->buf = calloc(1, buffer->capacity);
+        buffer->buf = buffer->inline_buf;
+        buffer->capacity = ENNA_BUFFER_INLINE_SIZE;
+        buffer->buf[0] = '\0';
+        return 1;
     }
 
-    len = buffer->len + strlen (str);
-    if (len >= buffer->capacity)
+    needed = MAX(needed, 2 * buffer->capacity);
+    if (buffer->buf == buffer->inline_buf || !buffer->buf)
     {
-        buffer->capacity = MAX(len + 1, 2 * buffer->capacity);
-        buffer->buf = realloc(buffer->buf, buffer->capacity);
+        tmp = malloc(needed);
+        if (!tmp)
+            return 0;
+        if (buffer->buf)
+            memcpy(tmp, buffer->buf, buffer->len + 1);
+        else
+            tmp[0] = '\0';
+    }
+    else
+    {
+        tmp = realloc(buffer->buf, needed);
+        if (!tmp)
+            return 0;
     }
 
-    strcat(buffer->buf, str);
-    buffer->len += strlen(str);
+    buffer->buf = tmp;
+    buffer->capacity = needed;
+    return 1;
+}
+
+void
+enna_buffer_append_length(Enna_Buffer *buffer, const char *str, size_t len)
+{
+    if (!buffer || !str)
+        return;
+
+    if (!_buffer_grow(buffer, len))
+        return;
+
+    memcpy(buffer->buf + buffer->len, str, len);
+    buffer->len += len;
+    buffer->buf[buffer->len] = '\0';
+}
+
+void
+enna_buffer_append(Enna_Buffer *buffer, const char *str)
+{
+    if (!buffer || !str)
+        return;
+
+    enna_buffer_append_length(buffer, str, strlen(str));
 }
 
 void
 enna_buffer_appendf(Enna_Buffer *buffer, const char *format, ...)
 {
-    char str[BUFFER_DEFAULT_CAPACITY];
+    size_t avail;
     int size;
     va_list va;
 
     if (!buffer || !format)
         return;
 
+    /* format straight at the tail, retry once with the exact size */
+    if (!_buffer_grow(buffer, 0))
+        return;
+
+    avail = buffer->capacity - buffer->len;
     va_start(va, format);
-    size = vsnprintf(str, BUFFER_DEFAULT_CAPACITY, format, va);
-    if (size >= BUFFER_DEFAULT_CAPACITY)
+    size = vsnprintf(buffer->buf + buffer->len, avail, format, va);
+    va_end(va);
+    if (size < 0)
     {
-        char *dynstr = malloc(size + 1);
-        vsnprintf(dynstr, size + 1, format, va);
-        enna_buffer_append(buffer, dynstr);
-        free(dynstr);
+        buffer->buf[buffer->len] = '\0';
+        return;
     }
-    else
-        enna_buffer_append(buffer, str);
-    va_end(va);
+
+    if ((size_t) size >= avail)
+    {
+        if (!_buffer_grow(buffer, size))
+        {
+            buffer->buf[buffer->len] = '\0';
+            return;
+        }
+        va_start(va, format);
+        vsnprintf(buffer->buf + buffer->len, size + 1, format, va);
+        va_end(va);
+    }
+
+    buffer->len += size;
 }
 
 void
-enna_buffer_free(Enna_Buffer *buffer)
+enna_buffer_release(Enna_Buffer *buffer)
 {
     if (!buffer)
         return;
 
-    if (buffer->buf)
+    if (buffer->buf && buffer->buf != buffer->inline_buf)
         free(buffer->buf);
+    enna_buffer_init(buffer);
+}
+
+void
+enna_buffer_free(Enna_Buffer *buffer)
+{
+    if (!buffer)
+        return;
+
+    enna_buffer_release(buffer);
     free(buffer);
 }
@@ -22,16 +22,37 @@
 #ifndef BUFFER_H
 #define BUFFER_H
 
+#include <stddef.h>
+
+/* Strings shorter than this never touch the heap. */
+#define ENNA_BUFFER_INLINE_SIZE 256
+
+/*
+ * buf stays NULL until something is appended, then points either to the
+ * inline storage or to a heap block once the content outgrows it. An
+ * Enna_Buffer must not be copied by value as buf may point into itself.
+ */
 typedef struct _Enna_Buffer {
     char *buf;
     size_t len;
     size_t capacity;
+    char inline_buf[ENNA_BUFFER_INLINE_SIZE];
 } Enna_Buffer;
 
 Enna_Buffer *enna_buffer_new(void);
 void enna_buffer_free(Enna_Buffer *buffer);
 
+/* Stack allocated variant: init before use, release when done. */
+void enna_buffer_init(Enna_Buffer *buffer);
+void enna_buffer_release(Enna_Buffer *buffer);
+
+/* Empty the buffer but keep its storage for the next appends. */
+void enna_buffer_reset(Enna_Buffer *buffer);
+
 void enna_buffer_append(Enna_Buffer *buffer, const char *str);
-void enna_buffer_appendf(Enna_Buffer *buffer, const char *format, ...);
+void enna_buffer_append_length(Enna_Buffer *buffer,
+                               const char *str, size_t len);
+void enna_buffer_appendf(Enna_Buffer *buffer, const char *format, ...)
+    __attribute__ ((format (printf, 2, 3)));
 
 #endif /* BUFFER_H */
@@ -0,0 +1,208 @@
+/*
+ * Enna Media Center
+ * Copyright (C) 2005-2013 Enna Team. All rights reserved.
+ *
+ * This file is part of Enna.
+ *
+ * Enna is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Enna is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Enna; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Microbenchmark of the URI construction done by localfiles for each
+ * directory entry. Build it with "make enna_buffer_bench" in src/bin.
+ *
+ * Usage: enna_buffer_bench [entries]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+
+#include "buffer.h"
+
+#define DEFAULT_ENTRIES 200000
+
+/* Replica of the former implementation, kept as the baseline. */
+typedef struct _Legacy_Buffer {
+    char *buf;
+    size_t len;
+    size_t capacity;
+} Legacy_Buffer;
+
+#define LEGACY_CAPACITY 32768
+
+static void
+legacy_append(Legacy_Buffer *buffer, const char *str)
+{
+    size_t len;
+
+    if (!buffer->buf)
+    {
+        buffer->capacity = LEGACY_CAPACITY;
+        buffer->buf = calloc(1, buffer->capacity);
+    }
+
+    len = buffer->len + strlen(str);
+    if (len >= buffer->capacity)
+    {
+        buffer->capacity = len + 1 > 2 * buffer->capacity ?
+            len + 1 : 2 * buffer->capacity;
+        buffer->buf = realloc(buffer->buf, buffer->capacity);
+    }
+
+    strcat(buffer->buf, str);
+    buffer->len += strlen(str);
+}
+
+static void
+legacy_appendf(Legacy_Buffer *buffer, const char *format, ...)
+{
+    char str[LEGACY_CAPACITY];
+    va_list va;
+
+    va_start(va, format);
+    vsnprintf(str, LEGACY_CAPACITY, format, va);
+    va_end(va);
+    legacy_append(buffer, str);
+}
+
+static double
+now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static const char *
+entry_name(int i)
+{
+    static char name[64];
+
+    snprintf(name, sizeof(name), "%05d - Some Artist - Some Title.flac", i);
+    return name;
+}
+
+static size_t
+bench_legacy(int entries)
+{
+    size_t total = 0;
+    int i;
+
+    for (i = 0; i < entries; i++)
+    {
+        Legacy_Buffer *uri, *mrl;
+
+        uri = calloc(1, sizeof(Legacy_Buffer));
+        mrl = calloc(1, sizeof(Legacy_Buffer));
+        legacy_appendf(uri, "/%s/localfiles/%s/%s%s",
+                       "music", "Music", "Albums/Some Album/", entry_name(i));
+        legacy_appendf(mrl, "%s/%s%s", "file:///home/user/Music",
+                       "Albums/Some Album/", entry_name(i));
+        total += uri->len + mrl->len;
+        free(uri->buf);
+        free(uri);
+        free(mrl->buf);
+        free(mrl);
+    }
+
+    return total;
+}
+
+static size_t
+bench_heap(int entries)
+{
+    size_t total = 0;
+    int i;
+
+    for (i = 0; i < entries; i++)
+    {
+        Enna_Buffer *uri, *mrl;
+
+        uri = enna_buffer_new();
+        mrl = enna_buffer_new();
+        enna_buffer_appendf(uri, "/%s/localfiles/%s/%s%s",
+                            "music", "Music", "Albums/Some Album/",
+                            entry_name(i));
+        enna_buffer_appendf(mrl, "%s/%s%s", "file:///home/user/Music",
+                            "Albums/Some Album/", entry_name(i));
+        total += uri->len + mrl->len;
+        enna_buffer_free(uri);
+        enna_buffer_free(mrl);
+    }
+
+    return total;
+}
+
+static size_t
+bench_stack(int entries)
+{
+    Enna_Buffer uri, mrl;
+    size_t total = 0;
+    int i;
+
+    enna_buffer_init(&uri);
+    enna_buffer_init(&mrl);
+    for (i = 0; i < entries; i++)
+    {
+        enna_buffer_reset(&uri);
+        enna_buffer_reset(&mrl);
+        enna_buffer_appendf(&uri, "/%s/localfiles/%s/%s%s",
+                            "music", "Music", "Albums/Some Album/",
+                            entry_name(i));
+        enna_buffer_appendf(&mrl, "%s/%s%s", "file:///home/user/Music",
+                            "Albums/Some Album/", entry_name(i));
+        total += uri.len + mrl.len;
+    }
+    enna_buffer_release(&uri);
+    enna_buffer_release(&mrl);
+
+    return total;
+}
+
+static void
+run(const char *name, size_t (*func)(int entries), int entries)
+{
+    double t0, t1;
+    size_t total;
+
+    t0 = now();
+    total = func(entries);
+    t1 = now();
+
+    printf("%-8s %8d entries %10.3f ms %8.1f ns/entry (%lu bytes)\n",
+           name, entries, (t1 - t0) * 1e3, (t1 - t0) * 1e9 / entries,
+           (unsigned long) total);
+}
+
+int
+main(int argc, char **argv)
+{
+    int entries = DEFAULT_ENTRIES;
+
+    if (argc > 1)
+        entries = atoi(argv[1]);
+    if (entries <= 0)
+        entries = DEFAULT_ENTRIES;
+
+    run("legacy", bench_legacy, entries);
+    run("heap", bench_heap, entries);
+    run("stack", bench_stack, entries);
+
+    return 0;
+}
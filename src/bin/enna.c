@@ -45,6 +45,10 @@
 #include "input.h"
 #include "gadgets.h"
 #include "videoplayer_obj.h"
+#include "trace.h"
+#include "resume.h"
+#include "artwork.h"
+#include "readahead.h"
 
 #ifdef HAVE_ECORE_X
 #include <Ecore_X.h>
@@ -211,6 +215,8 @@ static int _enna_init(int argc, char **argv)
     enna_mediaplayer_cfg_register();
     enna_videoplayer_obj_cfg_register();
     enna_metadata_cfg_register();
+    enna_trace_cfg_register();
+    enna_readahead_cfg_register();
 
     enna_module_init();
     enna_config_set_default();
@@ -226,6 +232,7 @@ static int _enna_init(int argc, char **argv)
     enna_log(ENNA_MSG_INFO, NULL, "enna log file : %s\n",
              enna_config->log_file);
     enna_log_init(enna_config->log_file);
+    enna_trace_init();
 
     if (enna_config->verbosity)
     {
@@ -262,6 +269,8 @@ static int _enna_init(int argc, char **argv)
 
     /* Init various stuff */
     enna_metadata_init ();
+    enna_resume_init();
+    enna_artwork_init();
 
     if (!enna_mediaplayer_init())
         return 0;
@@ -275,7 +284,13 @@ static int _enna_init(int argc, char **argv)
 
     /* Dinamically init activities */
     EINA_LIST_FOREACH(enna_activities_get(), l, a)
+    {
+        double t0 = ecore_time_get();
+
         enna_activity_init(a->name);
+        enna_log(ENNA_MSG_INFO, NULL, "Activity %s initialized in %.1f ms",
+                 a->name, (ecore_time_get() - t0) * 1000.0);
+    }
 
     /* Show mainmenu */
     //~ enna_mainmenu_select_nth(0);
@@ -392,12 +407,17 @@ static int _create_gui(void)
 
 static void _enna_shutdown(void)
 {
+    /* iterates the main loop, everything must still be up */
+    enna_module_jobs_wait();
     ENNA_TIMER_DEL(enna->idle_timer);
 
+    enna_trace_shutdown();
     enna_activity_del_all();
     enna_config_shutdown();
     enna_module_shutdown();
     enna_metadata_shutdown();
+    enna_resume_shutdown();
+    enna_artwork_shutdown();
     enna_mediaplayer_shutdown();
 
     evas_object_del(enna->o_background);
@@ -83,6 +83,7 @@ _inwin_hide(void)
 {
     ENNA_OBJECT_DEL(sd->inwin);
     sd->visible = EINA_FALSE;
+    enna_input_listener_priority_set(sd->listener, ENNA_INPUT_PRIORITY_LOW);
     enna_input_listener_demote(sd->listener);
 }
 
@@ -144,7 +145,8 @@ _inwin_show(void)
         enna_exit_update_text();
     enna_box_select_nth(sd->list, 0);
     sd->visible = EINA_TRUE;
-    enna_input_listener_promote(sd->listener);
+    /* modal, ahead of every listener including a focused entry */
+    enna_input_listener_priority_set(sd->listener, ENNA_INPUT_PRIORITY_MODAL);
 }
 
 static Eina_Bool
@@ -187,8 +189,12 @@ enna_exit_init()
 
     sd = calloc(1, sizeof(Smart_Data));
 
-    /* Add input listener at the lowest level */
-    sd->listener = enna_input_listener_add("exit_dialog", _input_events_cb, sd);
+    /* Add input listener at the lowest level, every class: the dialog
+     * swallows all the events while it is shown */
+    sd->listener = enna_input_listener_add_full("exit_dialog",
+                                                ENNA_INPUT_PRIORITY_LOW,
+                                                ENNA_INPUT_MASK_ALL,
+                                                _input_events_cb, sd);
     enna_input_listener_demote(sd->listener);
 
     _exit_init_count = 1;
@@ -25,6 +25,9 @@
 #include "logs.h"
 #include "utils.h"
 
+#define ARENA_CHUNK_SIZE 16384
+#define ARENA_ALIGN      (sizeof(void *))
+
 typedef struct _Enna_File_Callback Enna_File_Callback;
 struct _Enna_File_Callback
 {
@@ -32,6 +35,28 @@ struct _Enna_File_Callback
    void *func_data;
 };
 
+struct _Enna_File_Arena_Chunk
+{
+    Enna_File_Arena_Chunk *next;
+    size_t size;
+    size_t used;
+    int live;                   /* files of this chunk not freed yet */
+    unsigned char orphan : 1;   /* the arena has been released */
+    char data[];
+};
+
+struct _Enna_File_Arena
+{
+    Enna_File_Arena_Chunk *chunks;
+};
+
+struct _Enna_File_Dir
+{
+    const char *uri;
+    const char *mrl;
+    int refcount;
+};
+
 static Enna_File *
 _create_inode(const char *name, const char *uri, const char *label,
               const char *icon, const char *mrl, Enna_File_Type type)
@@ -50,13 +75,61 @@ _create_inode(const char *name, const char *uri, const char *label,
     return f;
 }
 
+static void *
+_arena_alloc(Enna_File_Arena *arena, size_t size)
+{
+    Enna_File_Arena_Chunk *c = arena->chunks;
+    void *p;
+
+    size = (size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+    if (!c || c->used + size > c->size)
+    {
+        size_t csize = size > ARENA_CHUNK_SIZE ? size : ARENA_CHUNK_SIZE;
+
+        c = malloc(sizeof(Enna_File_Arena_Chunk) + csize);
+        if (!c)
+            return NULL;
+        c->size = csize;
+        c->used = 0;
+        c->live = 0;
+        c->orphan = 0;
+        c->next = arena->chunks;
+        arena->chunks = c;
+    }
+
+    p = c->data + c->used;
+    c->used += size;
+    return p;
+}
+
+static void
+_arena_chunk_unref(Enna_File_Arena_Chunk *c)
+{
+    c->live--;
+    if (!c->live && c->orphan)
+        free(c);
+}
+
+/* Turn the arena copies into stringshares so that they can be replaced or
+ * released like the ones of any other file. */
+static void
+_file_strings_detach(Enna_File *f)
+{
+    if (!f->arena_strings)
+        return;
+
+    f->name  = f->name  ? eina_stringshare_add(f->name)  : NULL;
+    f->label = f->label ? eina_stringshare_add(f->label) : NULL;
+    f->arena_strings = 0;
+}
+
 static const char *
 _meta_get_default(Enna_File *file, const char *key)
 {
     Enna_Metadata *m;
     const char *str;
 
-    m = enna_metadata_meta_new(file->mrl);
+    m = enna_metadata_meta_new(enna_file_mrl_get(file));
     str = enna_metadata_meta_get(m, key, 0);
     enna_metadata_meta_free(m);
     return str;
@@ -68,7 +141,7 @@ _meta_default_set(Enna_File *file, const char *key, const char *data)
 {
     Enna_Metadata *m;
 
-    m = enna_metadata_meta_new(file->mrl);
+    m = enna_metadata_meta_new(enna_file_mrl_get(file));
     enna_metadata_meta_set(m, file, key, data);
     enna_metadata_meta_free(m);
     return;
@@ -93,8 +166,8 @@ enna_file_dup(Enna_File *file)
     f->type = file->type;
     f->label = eina_stringshare_add(file->label);
     f->name = eina_stringshare_add(file->name);
-    f->uri = eina_stringshare_add(file->uri);
-    f->mrl = eina_stringshare_add(file->mrl);
+    f->uri = eina_stringshare_add(enna_file_uri_get(file));
+    f->mrl = eina_stringshare_add(enna_file_mrl_get(file));
     f->meta_class = file->meta_class;
     f->meta_data = file->meta_data;
     f->callbacks = eina_list_clone(file->callbacks);
@@ -137,19 +210,347 @@ enna_file_free(Enna_File *f)
         return;
     }
 
-    if (f->name) eina_stringshare_del(f->name);
+    if (!f->arena_strings)
+    {
+        if (f->name) eina_stringshare_del(f->name);
+        if (f->label) eina_stringshare_del(f->label);
+    }
     if (f->uri) eina_stringshare_del(f->uri);
-    if (f->label) eina_stringshare_del(f->label);
+    if (f->mrl) eina_stringshare_del(f->mrl);
+    enna_file_dir_unref(f->dir);
     if (f->icon) eina_stringshare_del(f->icon);
     if (f->icon_file) eina_stringshare_del(f->icon_file);
-    if (f->mrl) eina_stringshare_del(f->mrl);
     if (f->meta_class && f->meta_class->meta_del)
         f->meta_class->meta_del(f->meta_data);
     if (f->callbacks)
         EINA_LIST_FREE(f->callbacks, cb)
             free(cb);
 
-    free(f);
+    if (f->chunk)
+        _arena_chunk_unref(f->chunk);
+    else
+        free(f);
+}
+
+void
+enna_file_update(Enna_File *file, Enna_File *from)
+{
+    if (!file || !from || file == from)
+        return;
+
+    /* the uri is kept, build it before the name changes */
+    enna_file_uri_get(file);
+    _file_strings_detach(file);
+    eina_stringshare_replace(&file->name, from->name);
+    eina_stringshare_replace(&file->label, from->label);
+    eina_stringshare_replace(&file->icon, from->icon);
+    eina_stringshare_replace(&file->icon_file, from->icon_file);
+    eina_stringshare_replace(&file->mrl, enna_file_mrl_get(from));
+    file->lazy_mrl = 0;
+    file->type = from->type;
+    file->meta_class = from->meta_class;
+    file->meta_data = from->meta_data;
+}
+
+Enna_File_Arena *
+enna_file_arena_new(void)
+{
+    return calloc(1, sizeof(Enna_File_Arena));
+}
+
+void
+enna_file_arena_release(Enna_File_Arena *arena)
+{
+    Enna_File_Arena_Chunk *c, *next;
+
+    if (!arena)
+        return;
+
+    for (c = arena->chunks; c; c = next)
+    {
+        next = c->next;
+        if (!c->live)
+            free(c);
+        else
+            c->orphan = 1;
+    }
+    free(arena);
+}
+
+Enna_File *
+enna_file_arena_add(Enna_File_Arena *arena, Enna_File_Type type,
+                    const char *name, const char *uri, const char *mrl,
+                    const char *label, const char *icon)
+{
+    Enna_File *f;
+    size_t name_len = 0, label_len = 0;
+    Eina_Bool label_is_name = EINA_FALSE;
+    char *p;
+
+    if (!arena)
+        return _create_inode(name, uri, label, icon, mrl, type);
+
+    /* listings mostly use the file name as label */
+    if (label && name && !strcmp(label, name))
+        label_is_name = EINA_TRUE;
+    else if (label)
+        label_len = strlen(label) + 1;
+    if (name)
+        name_len = strlen(name) + 1;
+
+    /* the strings share the block of the file, hence its chunk reference */
+    f = _arena_alloc(arena, sizeof(Enna_File) + name_len + label_len);
+    if (!f)
+        return NULL;
+
+    memset(f, 0, sizeof(Enna_File));
+    f->chunk = arena->chunks;
+    f->chunk->live++;
+    f->arena_strings = 1;
+
+    p = (char *) (f + 1);
+    if (name)
+    {
+        memcpy(p, name, name_len);
+        f->name = p;
+        p += name_len;
+    }
+    if (label_len)
+    {
+        memcpy(p, label, label_len);
+        f->label = p;
+    }
+    else if (label_is_name)
+        f->label = f->name;
+    f->uri   = uri ? eina_stringshare_add(uri) : NULL;
+    f->mrl   = mrl ? eina_stringshare_add(mrl) : NULL;
+    f->icon  = icon ? eina_stringshare_add(icon) : NULL;
+    f->type = type;
+    f->refcount++;
+
+    return f;
+}
+
+Enna_File_Dir *
+enna_file_dir_new(const char *uri, const char *mrl)
+{
+    Enna_File_Dir *dir;
+
+    dir = calloc(1, sizeof(Enna_File_Dir));
+    if (!dir)
+        return NULL;
+
+    dir->uri = uri ? eina_stringshare_add(uri) : NULL;
+    dir->mrl = mrl ? eina_stringshare_add(mrl) : NULL;
+    dir->refcount = 1;
+
+    return dir;
+}
+
+Enna_File_Dir *
+enna_file_dir_ref(Enna_File_Dir *dir)
+{
+    if (dir)
+        dir->refcount++;
+    return dir;
+}
+
+void
+enna_file_dir_unref(Enna_File_Dir *dir)
+{
+    if (!dir)
+        return;
+
+    dir->refcount--;
+    if (dir->refcount > 0)
+        return;
+
+    if (dir->uri) eina_stringshare_del(dir->uri);
+    if (dir->mrl) eina_stringshare_del(dir->mrl);
+    free(dir);
+}
+
+Enna_File *
+enna_file_child_add(Enna_File_Arena *arena, Enna_File_Dir *dir,
+                    Enna_File_Type type, const char *name,
+                    const char *label, const char *icon)
+{
+    Enna_File *f;
+
+    f = enna_file_arena_add(arena, type, name, NULL, NULL, label, icon);
+    if (!f || !dir)
+        return f;
+
+    f->dir = enna_file_dir_ref(dir);
+    f->lazy_uri = dir->uri ? 1 : 0;
+    /* directories never had a mrl */
+    f->lazy_mrl = (dir->mrl && type != ENNA_FILE_DIRECTORY) ? 1 : 0;
+
+    return f;
+}
+
+Enna_File_Array *
+enna_file_array_new(void)
+{
+    Enna_File_Array *array;
+
+    array = calloc(1, sizeof(Enna_File_Array));
+    if (!array)
+        return NULL;
+
+    array->refcount = 1;
+    return array;
+}
+
+Enna_File_Array *
+enna_file_array_ref(Enna_File_Array *array)
+{
+    if (array)
+        array->refcount++;
+    return array;
+}
+
+void
+enna_file_array_unref(Enna_File_Array *array)
+{
+    int i;
+
+    if (!array)
+        return;
+
+    array->refcount--;
+    if (array->refcount > 0)
+        return;
+
+    for (i = 0; i < array->count; i++)
+        enna_file_free(array->files[i]);
+    free(array->files);
+    free(array);
+}
+
+Enna_File_Array *
+enna_file_array_own(Enna_File_Array *array)
+{
+    Enna_File_Array *copy;
+    int i;
+
+    if (!array || array->refcount == 1)
+        return array;
+
+    copy = calloc(1, sizeof(Enna_File_Array));
+    if (!copy)
+        return NULL;
+
+    copy->size = array->count;
+    if (copy->size)
+    {
+        copy->files = malloc(copy->size * sizeof(Enna_File *));
+        if (!copy->files)
+        {
+            free(copy);
+            return NULL;
+        }
+    }
+    for (i = 0; i < array->count; i++)
+        copy->files[i] = enna_file_ref(array->files[i]);
+    copy->count = array->count;
+    copy->refcount = 1;
+
+    enna_file_array_unref(array);
+    return copy;
+}
+
+Eina_Bool
+enna_file_array_append(Enna_File_Array *array, Enna_File *file)
+{
+    if (!array || !file)
+        return EINA_FALSE;
+
+    if (array->count == array->size)
+    {
+        Enna_File **files;
+        int size = array->size ? array->size * 2 : 64;
+
+        files = realloc(array->files, size * sizeof(Enna_File *));
+        if (!files)
+            return EINA_FALSE;
+        array->files = files;
+        array->size = size;
+    }
+
+    file->index = array->count;
+    array->files[array->count++] = enna_file_ref(file);
+    return EINA_TRUE;
+}
+
+void
+enna_file_array_remove(Enna_File_Array *array, int index)
+{
+    Enna_File *file;
+    int i;
+
+    if (!array || index < 0 || index >= array->count)
+        return;
+
+    file = array->files[index];
+    array->count--;
+    memmove(array->files + index, array->files + index + 1,
+            (array->count - index) * sizeof(Enna_File *));
+    for (i = index; i < array->count; i++)
+        array->files[i]->index = i;
+    enna_file_free(file);
+}
+
+int
+enna_file_array_index_get(Enna_File_Array *array, Enna_File *file)
+{
+    int i;
+
+    if (!array || !file)
+        return -1;
+
+    if (file->index >= 0 && file->index < array->count &&
+        array->files[file->index] == file)
+        return file->index;
+
+    /* the hint is for another array */
+    for (i = 0; i < array->count; i++)
+        if (array->files[i] == file)
+            return i;
+
+    return -1;
+}
+
+const char *
+enna_file_uri_get(Enna_File *file)
+{
+    if (!file)
+        return NULL;
+
+    if (file->lazy_uri)
+    {
+        file->uri = eina_stringshare_printf("%s%s",
+                                            file->dir->uri, file->name);
+        file->lazy_uri = 0;
+    }
+
+    return file->uri;
+}
+
+const char *
+enna_file_mrl_get(Enna_File *file)
+{
+    if (!file)
+        return NULL;
+
+    if (file->lazy_mrl)
+    {
+        file->mrl = eina_stringshare_printf("%s%s",
+                                            file->dir->mrl, file->name);
+        file->lazy_mrl = 0;
+    }
+
+    return file->mrl;
 }
 
 void
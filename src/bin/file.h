@@ -35,6 +35,10 @@
 typedef struct _Enna_File Enna_File;
 typedef enum _Enna_File_Type Enna_File_Type;
 typedef struct _Enna_File_Meta_Class Enna_File_Meta_Class;
+typedef struct _Enna_File_Arena Enna_File_Arena;
+typedef struct _Enna_File_Arena_Chunk Enna_File_Arena_Chunk;
+typedef struct _Enna_File_Dir Enna_File_Dir;
+typedef struct _Enna_File_Array Enna_File_Array;
 
 struct _Enna_File_Meta_Class
 {
@@ -57,6 +61,8 @@ enum _Enna_File_Type
     ENNA_FILE_FILM
 };
 
+/* Do not read uri and mrl directly, files listed from a directory only
+ * build them on demand: use enna_file_uri_get() and enna_file_mrl_get(). */
 struct _Enna_File
 {
     const char *name;
@@ -70,6 +76,29 @@ struct _Enna_File
     void *meta_data;
     Eina_List *callbacks;
     int refcount;
+    /* set when the file lives in an arena, see enna_file_arena_add() */
+    Enna_File_Arena_Chunk *chunk;
+    /* name and label are arena copies, not stringshares */
+    unsigned char arena_strings : 1;
+    /* uri and mrl are built from dir and name on first access */
+    Enna_File_Dir *dir;
+    unsigned char lazy_uri : 1;
+    unsigned char lazy_mrl : 1;
+    /* position in the last array the file was appended to, a hint for
+     * enna_file_array_index_get() */
+    int index;
+};
+
+/* Refcounted array of files, shared instead of copied between a browser
+ * listing and the playlists playing it. It holds a reference on each of
+ * its files. A holder about to modify a shared array first gets its own
+ * copy with enna_file_array_own(). */
+struct _Enna_File_Array
+{
+    Enna_File **files;
+    int count;
+    int size;
+    int refcount;
 };
 
 typedef void (*Enna_File_Update_Cb) (void *data, Enna_File *file);
@@ -86,6 +115,15 @@ Enna_File *enna_file_file_add(const char *name, const char *uri,
 Enna_File *enna_file_track_add(const char *name, const char *uri,
                                const char *mrl, const char *label,
                                const char *icon);
+
+/* Parent directory shared by the files of a listing, uri and mrl are the
+ * prefixes the file name is appended to (with their trailing '/'). */
+Enna_File_Dir *enna_file_dir_new(const char *uri, const char *mrl);
+Enna_File_Dir *enna_file_dir_ref(Enna_File_Dir *dir);
+void enna_file_dir_unref(Enna_File_Dir *dir);
+Enna_File *enna_file_child_add(Enna_File_Arena *arena, Enna_File_Dir *dir,
+                               Enna_File_Type type, const char *name,
+                               const char *label, const char *icon);
 Enna_File *enna_file_film_add(const char *name, const char *uri,
                               const char *mrl, const char *label,
                               const char *icon);
@@ -95,7 +133,29 @@ Enna_File *enna_file_menu_add(const char *name, const char *uri,
                               const char *label, const char *icon);
 Enna_File *enna_file_volume_add(const char *name, const char *uri,
                                 const char *label, const char *icon);
+void enna_file_update(Enna_File *file, Enna_File *from);
+const char *enna_file_uri_get(Enna_File *file);
+const char *enna_file_mrl_get(Enna_File *file);
+
+/* Arena for files which are all dropped at once (a browser listing).
+ * Files keep their refcount semantics: the ones still referenced when the
+ * arena is released keep their chunk alive until their last unref. */
+Enna_File_Arena *enna_file_arena_new(void);
+void enna_file_arena_release(Enna_File_Arena *arena);
+Enna_File *enna_file_arena_add(Enna_File_Arena *arena, Enna_File_Type type,
+                               const char *name, const char *uri,
+                               const char *mrl, const char *label,
+                               const char *icon);
 
+Enna_File_Array *enna_file_array_new(void);
+Enna_File_Array *enna_file_array_ref(Enna_File_Array *array);
+void enna_file_array_unref(Enna_File_Array *array);
+/* array itself when not shared, else a private copy replacing the caller's
+ * reference, NULL (and array untouched) on allocation failure */
+Enna_File_Array *enna_file_array_own(Enna_File_Array *array);
+Eina_Bool enna_file_array_append(Enna_File_Array *array, Enna_File *file);
+void enna_file_array_remove(Enna_File_Array *array, int index);
+int enna_file_array_index_get(Enna_File_Array *array, Enna_File *file);
 
 void enna_file_meta_callback_add(Enna_File *file, Enna_File_Update_Cb func, void *data);
 void *enna_file_meta_callback_del(Enna_File *file, Enna_File_Update_Cb func);
@@ -31,6 +31,7 @@
 #include "infos.h"
 #include "utils.h"
 #include "infos_video_flags.h"
+#include "artwork.h"
 
 typedef struct _Smart_Data Smart_Data;
 
@@ -87,7 +88,10 @@ _update_icon(Evas_Object *parent, Enna_File *file, const char *key)
     }
     else if (path)
     {
-        elm_image_file_set(ic, path, NULL);
+        const char *art = enna_artwork_get(path, ENNA_ARTWORK_PANEL);
+
+        elm_image_file_set(ic, art, NULL);
+        eina_stringshare_del(art);
         eina_stringshare_del(path);
 
     }
@@ -188,7 +192,7 @@ _file_update_cb(void *data, Enna_File *file)
 {
     Smart_Data *sd = data;
 
-    DBG("File %s has meta update\n", file->uri);
+    DBG("File %s has meta update\n", enna_file_uri_get(file));
     _update(sd, file);
 }
 
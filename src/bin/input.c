@@ -27,83 +27,369 @@
 #include "enna.h"
 #include "input.h"
 #include "logs.h"
+#include "trace.h"
 
 
 struct _Input_Listener {
     const char *name;
+    const char *trace; /* "input/<name>", the trace dump keeps the pointer */
     Eina_Bool (*func)(void *data, enna_input event);
     void *data;
+    Eina_List *node;   /* in _listeners */
+    int priority;
+    int order;         /* within a priority, the highest goes first */
+    Enna_Input_Mask mask;
+    Eina_Bool deleted;
 };
 
+/*
+ * Held directional keys are queued instead of being dispatched as they
+ * come: remotes repeat much faster than the lists can scroll. The devices
+ * tell the auto-repeats from the presses and when they were received.
+ * The repeats of a frame are coalesced into a single step, which moves
+ * further the longer the key is held, and a repeat which has waited too
+ * long (the UI is behind) is dropped. Presses are never coalesced.
+ */
+#define INPUT_REPEAT_STALE 0.25
+
+typedef struct _Input_Repeat Input_Repeat;
+
+struct _Input_Repeat {
+    enna_input event;
+    double start; /* press, device time stamps */
+    double last;  /* last repeat */
+    int pending;  /* repeats received since the last step */
+    Ecore_Animator *animator;
+};
+
+/* events per step, after the key has been held for the given time */
+static const struct {
+    double held;
+    int step;
+} _accel[] = {
+    { 3.5, 10 },
+    { 2.0,  5 },
+    { 1.0,  2 },
+    { 0.0,  1 },
+};
+
+#define INPUT_CLASSES 6
 
 /* Local Globals */
 static Eina_List *_listeners = NULL;
+static Input_Repeat _repeat = { ENNA_INPUT_UNKNOWN, 0.0, 0.0, 0, NULL };
 
-/* Public Functions */
-Eina_Bool
-enna_input_event_emit(enna_input in)
+/*
+ * Dispatch table: for each event class, the listeners interested in it
+ * sorted by priority (NULL terminated). Listeners are rarely added or
+ * moved compared to the events, the table is only rebuilt on the next
+ * event after a change, and never while an event is being dispatched
+ * (listeners add, move and delete themselves from their callback).
+ */
+static Input_Listener **_table[INPUT_CLASSES];
+static Eina_Bool _table_dirty = EINA_TRUE;
+static int _dispatching = 0;
+static Eina_List *_deleted = NULL;
+static int _order_top = 0;
+static int _order_bottom = 0;
+
+static int
+_input_class_get(enna_input in)
+{
+    if (in < ENNA_INPUT_PLAY)
+        return 0;
+    if (in < ENNA_INPUT_VOLPLUS)
+        return 1;
+    if (in < ENNA_INPUT_SUBTITLES)
+        return 2;
+    if (in < ENNA_INPUT_RED)
+        return 3;
+    if (in < ENNA_INPUT_KEY_SPACE)
+        return 4;
+    return 5;
+}
+
+static int
+_input_listener_cmp(const void *a, const void *b)
+{
+    const Input_Listener *il1 = *(const Input_Listener * const *) a;
+    const Input_Listener *il2 = *(const Input_Listener * const *) b;
+
+    if (il1->priority != il2->priority)
+        return il2->priority - il1->priority;
+    return il2->order - il1->order;
+}
+
+static void
+_input_table_build(void)
 {
+    Input_Listener **sorted;
     Input_Listener *il;
     Eina_List *l;
+    unsigned int count, i;
+    int c, n;
+
+    for (c = 0; c < INPUT_CLASSES; c++)
+        ENNA_FREE(_table[c]);
+    _table_dirty = EINA_FALSE;
+
+    count = eina_list_count(_listeners);
+    if (!count)
+        return;
+
+    sorted = malloc(count * sizeof(Input_Listener *));
+    if (!sorted)
+        return;
+    i = 0;
+    EINA_LIST_FOREACH(_listeners, l, il)
+        sorted[i++] = il;
+    qsort(sorted, count, sizeof(Input_Listener *), _input_listener_cmp);
+
+    for (c = 0; c < INPUT_CLASSES; c++)
+    {
+        _table[c] = calloc(count + 1, sizeof(Input_Listener *));
+        if (!_table[c])
+            continue;
+        for (i = 0, n = 0; i < count; i++)
+            if (sorted[i]->mask & (1 << c))
+                _table[c][n++] = sorted[i];
+    }
+
+    free(sorted);
+}
+
+static void
+_input_listener_free(Input_Listener *il)
+{
+    eina_stringshare_del(il->name);
+    /* still referenced by the trace rings */
+    if (!enna_trace_enabled)
+        eina_stringshare_del(il->trace);
+    ENNA_FREE(il);
+}
+
+static void
+_input_dispatch(enna_input in)
+{
+    Input_Listener **it;
+    Input_Listener *il;
     Eina_Bool ret;
 
+    if (_table_dirty && !_dispatching)
+        _input_table_build();
+
     enna_log(ENNA_MSG_EVENT, NULL, "Input emit: %d (listeners: %d)", in, eina_list_count(_listeners));
 
+    ENNA_TRACE_BEGIN("input/event_emit");
     enna_idle_timer_renew();
-    EINA_LIST_FOREACH(_listeners, l, il)
+    _dispatching++;
+    for (it = _table[_input_class_get(in)]; it && *it; it++)
     {
+        il = *it;
+        if (il->deleted || !il->func) continue;
         enna_log(ENNA_MSG_EVENT, NULL, "  emit to: %s", il->name);
-        if (!il->func) continue;
 
+        ENNA_TRACE_BEGIN(il->trace);
         ret = il->func(il->data, in);
+        ENNA_TRACE_END(il->trace);
         if (ret == ENNA_EVENT_BLOCK)
         {
             enna_log(ENNA_MSG_EVENT, NULL, "  emission stopped by: %s", il->name);
-            return EINA_TRUE;
+            break;
         }
     }
+    _dispatching--;
+
+    if (!_dispatching)
+        EINA_LIST_FREE(_deleted, il)
+            _input_listener_free(il);
+    ENNA_TRACE_END("input/event_emit");
+}
+
+static Eina_Bool
+_input_repeatable(enna_input in)
+{
+    switch (in)
+    {
+    case ENNA_INPUT_LEFT:
+    case ENNA_INPUT_RIGHT:
+    case ENNA_INPUT_UP:
+    case ENNA_INPUT_DOWN:
+        return EINA_TRUE;
+    default:
+        return EINA_FALSE;
+    }
+}
+
+static void
+_input_repeat_flush(void)
+{
+    double held;
+    int step = 1;
+    unsigned int i;
+
+    if (_repeat.animator)
+        ecore_animator_del(_repeat.animator);
+    _repeat.animator = NULL;
+
+    if (!_repeat.pending)
+        return;
+
+    if (ecore_time_get() - _repeat.last > INPUT_REPEAT_STALE)
+    {
+        enna_log(ENNA_MSG_EVENT, NULL, "Input drop: %d (%d stale repeats)",
+                 _repeat.event, _repeat.pending);
+        _repeat.pending = 0;
+        return;
+    }
+    _repeat.pending = 0;
+
+    held = _repeat.last - _repeat.start;
+    for (i = 0; i < sizeof(_accel) / sizeof(_accel[0]); i++)
+        if (held >= _accel[i].held)
+        {
+            step = _accel[i].step;
+            break;
+        }
+
+    /* within one frame, the list is rendered once whatever the step */
+    for (; step > 0; step--)
+        _input_dispatch(_repeat.event);
+}
+
+static Eina_Bool
+_input_repeat_frame_cb(void *data EINA_UNUSED)
+{
+    _repeat.animator = NULL;
+    _input_repeat_flush();
+    return ECORE_CALLBACK_CANCEL;
+}
+
+static void
+_input_queue(const Enna_Input_Event *ev)
+{
+    if (ev->repeat && ev->input == _repeat.event &&
+        _repeat.event != ENNA_INPUT_UNKNOWN)
+    {
+        if (ecore_time_get() - ev->timestamp > INPUT_REPEAT_STALE)
+        {
+            enna_log(ENNA_MSG_EVENT, NULL, "Input drop: %d (stale repeat)",
+                     ev->input);
+            return;
+        }
+        _repeat.last = ev->timestamp;
+        _repeat.pending++;
+        if (!_repeat.animator)
+            _repeat.animator = ecore_animator_add(_input_repeat_frame_cb, NULL);
+        return;
+    }
+
+    /* keep the order, what is queued goes before this event */
+    _input_repeat_flush();
+
+    /* a repeat whose press was not seen starts the hold as well */
+    _repeat.event = _input_repeatable(ev->input) ? ev->input : ENNA_INPUT_UNKNOWN;
+    _repeat.start = _repeat.last = ev->timestamp;
+
+    _input_dispatch(ev->input);
+}
+
+/* Public Functions */
+Eina_Bool
+enna_input_event_emit(enna_input in)
+{
+    Enna_Input_Event ev;
+
+    ev.input = in;
+    ev.repeat = EINA_FALSE;
+    ev.timestamp = ecore_time_get();
+    _input_queue(&ev);
+    return EINA_TRUE;
+}
+
+Eina_Bool
+enna_input_event_emit_full(const Enna_Input_Event *ev)
+{
+    if (!ev)
+        return EINA_FALSE;
+
+    _input_queue(ev);
+    return EINA_TRUE;
+}
+
+Eina_Bool
+enna_input_events_emit(const Enna_Input_Event *ev, unsigned int count)
+{
+    unsigned int i;
+
+    for (i = 0; i < count; i++)
+        _input_queue(&ev[i]);
 
     return EINA_TRUE;
 }
 
 Input_Listener *
-enna_input_listener_add(const char *name,
-                        Eina_Bool(*func)(void *data, enna_input event),
-                        void *data)
+enna_input_listener_add_full(const char *name, int priority,
+                             Enna_Input_Mask mask,
+                             Eina_Bool(*func)(void *data, enna_input event),
+                             void *data)
 {
     Input_Listener *il;
 
-    enna_log(ENNA_MSG_INFO, NULL, "listener add: %s", name);
+    enna_log(ENNA_MSG_INFO, NULL, "listener add: %s (priority: %d, mask: 0x%x)",
+             name, priority, mask);
     il = ENNA_NEW(Input_Listener, 1);
     if (!il) return NULL;
     il->name = eina_stringshare_add(name);
+    il->trace = eina_stringshare_printf("input/%s", name);
     il->func = func;
     il->data = data;
+    il->priority = priority;
+    il->order = ++_order_top;
+    il->mask = mask;
 
-    _listeners = eina_list_prepend(_listeners, il);
+    _listeners = eina_list_append(_listeners, il);
+    il->node = eina_list_last(_listeners);
+    _table_dirty = EINA_TRUE;
     return il;
 }
 
+Input_Listener *
+enna_input_listener_add(const char *name,
+                        Eina_Bool(*func)(void *data, enna_input event),
+                        void *data)
+{
+    return enna_input_listener_add_full(name, ENNA_INPUT_PRIORITY_NORMAL,
+                                        ENNA_INPUT_MASK_ALL, func, data);
+}
+
+/* Move a listener to another priority, first within it */
 void
-enna_input_listener_promote(Input_Listener *il)
+enna_input_listener_priority_set(Input_Listener *il, int priority)
 {
-    Eina_List *l;
+    if (!il) return;
 
-    l = eina_list_data_find_list(_listeners, il);
-    if (!l) return;
+    il->priority = priority;
+    il->order = ++_order_top;
+    _table_dirty = EINA_TRUE;
+}
 
-    _listeners  = eina_list_promote_list(_listeners, l);
+void
+enna_input_listener_promote(Input_Listener *il)
+{
+    if (!il) return;
+
+    il->order = ++_order_top;
+    _table_dirty = EINA_TRUE;
 }
 
 void
 enna_input_listener_demote(Input_Listener *il)
 {
-    Eina_List *l;
-
-    l = eina_list_data_find_list(_listeners, il);
-    if (!l) return;
+    if (!il) return;
 
-    _listeners  = eina_list_demote_list(_listeners, l);
+    il->order = --_order_bottom;
+    _table_dirty = EINA_TRUE;
 }
 
 void
@@ -111,7 +397,15 @@ enna_input_listener_del(Input_Listener *il)
 {
     if (!il) return;
     enna_log(ENNA_MSG_INFO, NULL, "listener del: %s", il->name);
-    _listeners = eina_list_remove(_listeners, il);
-    eina_stringshare_del(il->name);
-    ENNA_FREE(il);
+    _listeners = eina_list_remove_list(_listeners, il->node);
+    _table_dirty = EINA_TRUE;
+
+    /* the dispatch loop may still hold it */
+    if (_dispatching)
+    {
+        il->deleted = EINA_TRUE;
+        _deleted = eina_list_append(_deleted, il);
+        return;
+    }
+    _input_listener_free(il);
 }
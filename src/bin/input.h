@@ -141,11 +141,48 @@ typedef enum
     ENNA_INPUT_KEY_Z,
 } enna_input;
 
+/* Event classes a listener is interested in, following the groups above */
+typedef enum
+{
+    ENNA_INPUT_MASK_NAVIGATION = 1 << 0, /* ENNA_INPUT_UNKNOWN .. ROTATE_CCW */
+    ENNA_INPUT_MASK_PLAYER     = 1 << 1,
+    ENNA_INPUT_MASK_AUDIO      = 1 << 2,
+    ENNA_INPUT_MASK_SUBTITLES  = 1 << 3,
+    ENNA_INPUT_MASK_TV         = 1 << 4,
+    ENNA_INPUT_MASK_KEYS       = 1 << 5, /* space, numbers and letters */
+    ENNA_INPUT_MASK_ALL        = (1 << 6) - 1
+} Enna_Input_Mask;
+
+/* Listeners with a higher priority are called first, within a priority
+ * the last added or promoted one goes first: promote and demote never move
+ * a listener out of its priority (a promoted NORMAL listener still comes
+ * after the HIGH ones), enna_input_listener_priority_set() does. */
+#define ENNA_INPUT_PRIORITY_LOW    -100
+#define ENNA_INPUT_PRIORITY_NORMAL 0
+#define ENNA_INPUT_PRIORITY_HIGH   100
+#define ENNA_INPUT_PRIORITY_MODAL  1000 /* modal dialogs while shown */
+
+
+typedef struct _Enna_Input_Event Enna_Input_Event;
+
+/* An event as read from a device */
+struct _Enna_Input_Event
+{
+    enna_input input;
+    Eina_Bool repeat;   /* auto-repeat of a held key, not a new press */
+    double timestamp;   /* when it was received, ecore_time_get() based */
+};
 
 /* Enna Event API functions */
+/* a press received right now */
 Eina_Bool enna_input_event_emit(enna_input in);
+Eina_Bool enna_input_event_emit_full(const Enna_Input_Event *ev);
+/* Events read at once from a device, queued in order */
+Eina_Bool enna_input_events_emit(const Enna_Input_Event *ev, unsigned int count);
 
 Input_Listener *enna_input_listener_add(const char *name, Eina_Bool (*func)(void *data, enna_input event), void *data);
+Input_Listener *enna_input_listener_add_full(const char *name, int priority, Enna_Input_Mask mask, Eina_Bool (*func)(void *data, enna_input event), void *data);
+void enna_input_listener_priority_set(Input_Listener *il, int priority);
 void enna_input_listener_promote(Input_Listener *il);
 void enna_input_listener_demote(Input_Listener *il);
 void enna_input_listener_del(Input_Listener *il);
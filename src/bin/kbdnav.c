@@ -21,6 +21,7 @@
 
 #include "kbdnav.h"
 #include "logs.h"
+#include "trace.h"
 
 #include <Evas.h>
 #include <Elementary.h>
@@ -284,29 +285,41 @@ _kbdnav_direction(Enna_Kbdnav *nav, int direction)
     return EINA_FALSE;
 }
 
+static Eina_Bool
+_kbdnav_move(Enna_Kbdnav *nav, int direction)
+{
+    Eina_Bool ret;
+
+    ENNA_TRACE_BEGIN("kbdnav/move");
+    ret = _kbdnav_direction(nav, direction);
+    ENNA_TRACE_END("kbdnav/move");
+
+    return ret;
+}
+
 Eina_Bool 
 enna_kbdnav_up(Enna_Kbdnav *nav)
 {
-    return _kbdnav_direction(nav, UP);
+    return _kbdnav_move(nav, UP);
 }
 
 Eina_Bool 
 enna_kbdnav_right(Enna_Kbdnav *nav)
 {
-    return _kbdnav_direction(nav, RIGHT);
+    return _kbdnav_move(nav, RIGHT);
 }
 
 Eina_Bool 
 enna_kbdnav_down(Enna_Kbdnav *nav)
 {
-    return _kbdnav_direction(nav, DOWN);
+    return _kbdnav_move(nav, DOWN);
 }
 
 
 Eina_Bool 
 enna_kbdnav_left(Enna_Kbdnav *nav)
 {
-    return _kbdnav_direction(nav, LEFT);
+    return _kbdnav_move(nav, LEFT);
 }
 
 void 
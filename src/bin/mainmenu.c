@@ -179,6 +179,7 @@ enna_mainmenu_add(Evas_Object *parent)
     evas_object_show(sd->o_menu);
 
     /* connect to the input signal */
+    /* every class: the events go on to the running activity */
     sd->listener = enna_input_listener_add("mainmenu", _input_events_cb, sd);
     _enna_mainmenu_load_from_activities(sd);
 
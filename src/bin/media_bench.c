@@ -0,0 +1,474 @@
+/*
+ * Enna Media Center
+ * Copyright (C) 2005-2013 Enna Team. All rights reserved.
+ *
+ * This file is part of Enna.
+ *
+ * Enna is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Enna is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Enna; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+
+/*
+ * Start-up latency benchmark of the media players. Nothing is displayed,
+ * the canvas is rendered by the buffer engine. Build it with
+ * "make enna_media_bench" in src/bin.
+ *
+ * Usage: enna_media_bench [-v] [-s seconds] [-o file.json] file...
+ *
+ * Each file is played through the mediaplayer, and with -v through the
+ * video player view as well. Measured, in milliseconds:
+ *  - open: from the play request to the first decoded frame, or to the
+ *    first position update for audio only streams,
+ *  - seek: from enna_mediaplayer_seek_relative() to the first position
+ *    update next to the target (mediaplayer only),
+ *  - switch: from the request of the next file to its first frame.
+ * A step which does not complete within STEP_TIMEOUT is reported as null.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <Elementary.h>
+#include <Emotion.h>
+
+#include "enna.h"
+#include "enna_config.h"
+#include "logs.h"
+#include "file.h"
+#include "mediaplayer.h"
+#include "videoplayer_obj.h"
+#include "readahead.h"
+
+#define STEP_TIMEOUT  10.0 /* seconds */
+#define SEEK_DEFAULT  10   /* seconds */
+/* a new file is playing once its position is back under this */
+#define SWITCH_POS    2.0
+
+typedef enum _Bench_Step
+{
+    STEP_OPEN,
+    STEP_SEEK,
+    STEP_SWITCH
+} Bench_Step;
+
+typedef struct _Bench_Run Bench_Run;
+
+struct _Bench_Run
+{
+    const char *file;
+    const char *player;
+    /* milliseconds, negative when not measured */
+    double open;
+    double seek;
+    double sw;
+    /* read-ahead of this file only, the counters restart with each file */
+    Enna_Readahead_Stats readahead;
+    Eina_Bool readahead_set;
+};
+
+Enna *enna = NULL;
+
+static struct
+{
+    Enna_File **files;
+    int count;
+    int index;
+    Eina_Bool video;       /* current pass drives the video player view */
+    int seek;
+    Enna_Playlist *pl;
+    Evas_Object *view;
+    Evas_Object *emotion;  /* object whose callbacks are listened to */
+    Bench_Step step;
+    double t0;
+    double target;
+    Ecore_Timer *timeout;
+    Bench_Run *run;
+    Eina_List *runs;
+} bench;
+
+static void _bench_run_start(void *data);
+static Eina_Bool _bench_timeout_cb(void *data);
+static void _bench_emotion_cb(void *data, Evas_Object *obj, void *event_info);
+
+static double
+_ms_since(double t0)
+{
+    return (ecore_time_get() - t0) * 1000.0;
+}
+
+static void
+_bench_observe(Evas_Object *emotion)
+{
+    if (emotion == bench.emotion)
+        return;
+
+    if (bench.emotion)
+    {
+        evas_object_smart_callback_del(bench.emotion, "frame_decode",
+                                       _bench_emotion_cb);
+        evas_object_smart_callback_del(bench.emotion, "position_update",
+                                       _bench_emotion_cb);
+    }
+    bench.emotion = emotion;
+    if (!emotion)
+        return;
+
+    evas_object_smart_callback_add(emotion, "frame_decode",
+                                   _bench_emotion_cb, (void *) 1);
+    evas_object_smart_callback_add(emotion, "position_update",
+                                   _bench_emotion_cb, NULL);
+}
+
+static void
+_bench_readahead_save(void)
+{
+    if (!bench.run || bench.run->readahead_set)
+        return;
+
+    enna_readahead_stats_get(&bench.run->readahead);
+    bench.run->readahead_set = EINA_TRUE;
+}
+
+static void
+_bench_run_end(void)
+{
+    ENNA_TIMER_DEL(bench.timeout);
+    _bench_readahead_save();
+
+    if (bench.video)
+        enna_view_player_video_stop(bench.view);
+    else
+        enna_mediaplayer_stop();
+
+    bench.index++;
+    ecore_job_add(_bench_run_start, NULL);
+}
+
+static void
+_bench_step_set(Bench_Step step)
+{
+    bench.step = step;
+    bench.t0 = ecore_time_get();
+
+    switch (step)
+    {
+    case STEP_OPEN:
+        if (bench.video)
+        {
+            enna_view_player_video_uri_set(bench.view,
+                                            bench.files[bench.index]);
+            enna_view_player_video_play(bench.view);
+            _bench_observe(enna_view_player_video_emotion_get(bench.view));
+        }
+        else
+        {
+            enna_mediaplayer_select_nth(bench.pl, bench.index);
+            enna_mediaplayer_play(bench.pl);
+            _bench_observe(enna_mediaplayer_obj_get());
+        }
+        break;
+    case STEP_SEEK:
+        bench.target = enna_mediaplayer_position_get() + bench.seek;
+        enna_mediaplayer_seek_relative(bench.seek);
+        break;
+    case STEP_SWITCH:
+        /* the next file restarts the read-ahead counters */
+        _bench_readahead_save();
+        if (bench.video)
+        {
+            enna_view_player_video_uri_set(bench.view,
+                                           bench.files[bench.index + 1]);
+            enna_view_player_video_play(bench.view);
+        }
+        else
+        {
+            enna_mediaplayer_next(bench.pl);
+            /* the gapless player may have swapped the emotion objects */
+            _bench_observe(enna_mediaplayer_obj_get());
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+/* Go on with the step after the one just measured (or timed out) */
+static void
+_bench_step_next(void)
+{
+    ENNA_TIMER_DEL(bench.timeout);
+
+    if (bench.step == STEP_OPEN && !bench.video && bench.seek > 0)
+        _bench_step_set(STEP_SEEK);
+    else if (bench.step != STEP_SWITCH && bench.index + 1 < bench.count)
+        _bench_step_set(STEP_SWITCH);
+    else
+    {
+        _bench_run_end();
+        return;
+    }
+
+    bench.timeout = ecore_timer_add(STEP_TIMEOUT, _bench_timeout_cb, NULL);
+}
+
+static Eina_Bool
+_bench_timeout_cb(void *data EINA_UNUSED)
+{
+    fprintf(stderr, "%s: step %d timed out\n",
+            enna_file_mrl_get(bench.files[bench.index]), bench.step);
+    bench.timeout = NULL;
+    _bench_step_next();
+    return ECORE_CALLBACK_CANCEL;
+}
+
+static void
+_bench_emotion_cb(void *data, Evas_Object *obj, void *event_info EINA_UNUSED)
+{
+    Eina_Bool frame = !!data;
+    double pos;
+
+    if (!bench.run || obj != bench.emotion)
+        return;
+
+    pos = emotion_object_position_get(obj);
+    switch (bench.step)
+    {
+    case STEP_OPEN:
+        if (!frame && pos <= 0.0)
+            return;
+        bench.run->open = _ms_since(bench.t0);
+        break;
+    case STEP_SEEK:
+        if (frame || pos < bench.target - 0.5)
+            return;
+        bench.run->seek = _ms_since(bench.t0);
+        break;
+    case STEP_SWITCH:
+        if (pos > SWITCH_POS || (!frame && pos <= 0.0))
+            return;
+        bench.run->sw = _ms_since(bench.t0);
+        break;
+    default:
+        return;
+    }
+
+    _bench_step_next();
+}
+
+static void
+_bench_run_start(void *data EINA_UNUSED)
+{
+    Bench_Run *run;
+
+    if (bench.index >= bench.count)
+    {
+        if (bench.video || !bench.view)
+        {
+            bench.run = NULL;
+            ecore_main_loop_quit();
+            return;
+        }
+        /* second pass, through the video player view */
+        bench.video = EINA_TRUE;
+        bench.index = 0;
+        _bench_observe(NULL);
+    }
+
+    run = calloc(1, sizeof(Bench_Run));
+    run->file = enna_file_mrl_get(bench.files[bench.index]);
+    run->player = bench.video ? "video" : "mediaplayer";
+    run->open = run->seek = run->sw = -1.0;
+    bench.runs = eina_list_append(bench.runs, run);
+    bench.run = run;
+
+    _bench_step_set(STEP_OPEN);
+    bench.timeout = ecore_timer_add(STEP_TIMEOUT, _bench_timeout_cb, NULL);
+}
+
+static void
+_json_string(FILE *f, const char *str)
+{
+    fputc('"', f);
+    for (; str && *str; str++)
+    {
+        if (*str == '"' || *str == '\\')
+            fputc('\\', f);
+        fputc(*str, f);
+    }
+    fputc('"', f);
+}
+
+static void
+_json_ms(FILE *f, const char *key, double ms)
+{
+    if (ms < 0.0)
+        fprintf(f, ",\"%s\":null", key);
+    else
+        fprintf(f, ",\"%s\":%.3f", key, ms);
+}
+
+static void
+_bench_dump(FILE *f)
+{
+    Bench_Run *run;
+    Eina_List *l;
+    Eina_Bool first = EINA_TRUE;
+
+    fprintf(f, "{\"seek_step\":%d,\"runs\":[", bench.seek);
+    EINA_LIST_FOREACH(bench.runs, l, run)
+    {
+        fprintf(f, "%s\n{\"file\":", first ? "" : ",");
+        _json_string(f, run->file);
+        fprintf(f, ",\"player\":\"%s\"", run->player);
+        _json_ms(f, "open_ms", run->open);
+        _json_ms(f, "seek_ms", run->seek);
+        _json_ms(f, "switch_ms", run->sw);
+        fprintf(f, ",\"readahead\":{\"underruns\":%u,\"seeks\":%u,"
+                "\"chunks\":%u,\"bytes\":%llu,\"latency_max_ms\":%.3f,"
+                "\"depth\":%d}}",
+                run->readahead.underruns, run->readahead.seeks,
+                run->readahead.chunks, run->readahead.bytes,
+                run->readahead.latency_max * 1000.0, run->readahead.depth);
+        first = EINA_FALSE;
+    }
+
+    fprintf(f, "\n]}\n");
+}
+
+static void
+_usage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [-v] [-s seconds] [-o file.json] file...\n"
+            "  -v  also play the files through the video player view\n"
+            "  -s  seek step (default %d, 0 to skip)\n"
+            "  -o  write the results there instead of stdout\n",
+            name, SEEK_DEFAULT);
+}
+
+int
+main(int argc, char **argv)
+{
+    const char *output = NULL;
+    Eina_Bool video = EINA_FALSE;
+    Bench_Run *run;
+    FILE *f = stdout;
+    int c, i;
+
+    bench.seek = SEEK_DEFAULT;
+    while ((c = getopt(argc, argv, "vs:o:h")) != -1)
+    {
+        switch (c)
+        {
+        case 'v':
+            video = EINA_TRUE;
+            break;
+        case 's':
+            bench.seek = atoi(optarg);
+            break;
+        case 'o':
+            output = optarg;
+            break;
+        default:
+            _usage(argv[0]);
+            return 1;
+        }
+    }
+    if (optind >= argc)
+    {
+        _usage(argv[0]);
+        return 1;
+    }
+
+    /* no display needed */
+    setenv("ELM_ENGINE", "buffer", 1);
+    elm_init(argc, argv);
+
+    enna = calloc(1, sizeof(Enna));
+    enna->lvl = ENNA_MSG_WARNING;
+
+    enna_config_init(NULL);
+    enna_main_cfg_register();
+    enna_mediaplayer_cfg_register();
+    enna_videoplayer_obj_cfg_register();
+    enna_readahead_cfg_register();
+    enna_config_set_default();
+    enna_config_load();
+    enna_config_load_theme();
+
+    enna->win = elm_win_add(NULL, "enna_media_bench", ELM_WIN_BASIC);
+    evas_object_resize(enna->win, 1280, 720);
+    evas_object_show(enna->win);
+    enna->evas = evas_object_evas_get(enna->win);
+    enna->layout = evas_object_rectangle_add(enna->evas);
+
+    if (!enna_mediaplayer_init())
+        return 1;
+
+    bench.pl = enna_mediaplayer_playlist_create();
+    bench.count = argc - optind;
+    bench.files = calloc(bench.count, sizeof(Enna_File *));
+    for (i = 0; i < bench.count; i++)
+    {
+        char mrl[4096];
+        const char *path = argv[optind + i];
+
+        if (strstr(path, "://"))
+            snprintf(mrl, sizeof(mrl), "%s", path);
+        else
+            snprintf(mrl, sizeof(mrl), "file://%s", path);
+        bench.files[i] = enna_file_file_add(path, mrl, mrl, path, NULL);
+        enna_mediaplayer_file_append(bench.pl, bench.files[i]);
+    }
+
+    if (video)
+    {
+        bench.view = enna_view_player_video_add(enna->win);
+        evas_object_resize(bench.view, 1280, 720);
+        evas_object_show(bench.view);
+    }
+
+    ecore_job_add(_bench_run_start, NULL);
+    ecore_main_loop_begin();
+
+    if (output)
+    {
+        f = fopen(output, "w");
+        if (!f)
+        {
+            fprintf(stderr, "unable to open %s\n", output);
+            f = stdout;
+        }
+    }
+    _bench_dump(f);
+    if (f != stdout)
+        fclose(f);
+
+    _bench_observe(NULL);
+    ENNA_OBJECT_DEL(bench.view);
+    enna_mediaplayer_playlist_free(bench.pl);
+    enna_mediaplayer_shutdown();
+    EINA_LIST_FREE(bench.runs, run)
+        free(run);
+    for (i = 0; i < bench.count; i++)
+        enna_file_free(bench.files[i]);
+    free(bench.files);
+    free(enna);
+    elm_shutdown();
+
+    return 0;
+}
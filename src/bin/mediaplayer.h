@@ -25,6 +25,7 @@
 #include "enna.h"
 #include "metadata.h"
 #include "input.h"
+#include "playlist_file.h"
 
 typedef enum
 {
@@ -78,10 +79,23 @@ struct _Enna_Event_Mediaplayer_Seek_Data
 
 typedef struct _Enna_Playlist Enna_Playlist;
 
+/* Files are stored in an array in the order they were added. When shuffle
+ * is on, order maps the play positions to files indexes and pos is its
+ * inverse, both NULL otherwise. selected is a play position.
+ * A view playlist plays the files of a shared array (view) without copying
+ * them, it gets its own array on its first modification. */
 struct _Enna_Playlist
 {
     int selected;
-    Eina_List *playlist;
+    Enna_File **files;
+    Enna_File_Array *view;
+    int count;
+    int size;
+    int *order;
+    int *pos;
+    Eina_Bool shuffle : 1;
+    Eina_Bool repeat : 1;
+    Enna_Playlist_Loader *loader;
 };
 
 /* Mediaplayer event */
@@ -94,6 +108,8 @@ int ENNA_EVENT_MEDIAPLAYER_UNPAUSE;
 int ENNA_EVENT_MEDIAPLAYER_PREV;
 int ENNA_EVENT_MEDIAPLAYER_NEXT;
 int ENNA_EVENT_MEDIAPLAYER_SEEK;
+/* sent on each position change of the current stream, no data */
+int ENNA_EVENT_MEDIAPLAYER_POSITION;
 
 /* Mediaplayer API functions */
 int enna_mediaplayer_supported_uri_type(enna_mediaplayer_uri_type_t type);
@@ -101,6 +117,11 @@ void enna_mediaplayer_cfg_register(void);
 int enna_mediaplayer_init(void);
 void enna_mediaplayer_shutdown(void);
 void enna_mediaplayer_file_append(Enna_Playlist *enna_playlist, Enna_File *file);
+void enna_mediaplayer_file_play_next(Enna_Playlist *enna_playlist, Enna_File *file);
+void enna_mediaplayer_shuffle_set(Enna_Playlist *enna_playlist, Eina_Bool shuffle);
+Eina_Bool enna_mediaplayer_shuffle_get(Enna_Playlist *enna_playlist);
+void enna_mediaplayer_repeat_set(Enna_Playlist *enna_playlist, Eina_Bool repeat);
+Eina_Bool enna_mediaplayer_repeat_get(Enna_Playlist *enna_playlist);
 int enna_mediaplayer_select_nth(Enna_Playlist *enna_playlist, int n);
 int enna_mediaplayer_selected_get(Enna_Playlist *enna_playlist);
 Enna_Metadata *enna_mediaplayer_metadata_get(Enna_Playlist *enna_playlist);
@@ -118,14 +139,16 @@ void enna_mediaplayer_seek_relative(int seconds);
 void enna_mediaplayer_default_seek_backward (void);
 void enna_mediaplayer_default_seek_forward (void);
 void enna_mediaplayer_video_resize(int x, int y, int w, int h);
-int enna_mediaplayer_playlist_load(const char *filename);
-int enna_mediaplayer_playlist_save(const char *filename);
+int enna_mediaplayer_playlist_load(Enna_Playlist *enna_playlist, const char *filename);
+int enna_mediaplayer_playlist_save(Enna_Playlist *enna_playlist, const char *filename);
 void enna_mediaplayer_playlist_clear(Enna_Playlist *enna_playlist);
 int enna_mediaplayer_playlist_count(Enna_Playlist *enna_playlist);
 PLAY_STATE enna_mediaplayer_state_get(void);
 Enna_Playlist *enna_mediaplayer_playlist_create(void);
 void enna_mediaplayer_playlist_free(Enna_Playlist *enna_playlist);
 void enna_mediaplayer_playlist_stop_clear(Enna_Playlist *enna_playlist);
+void enna_mediaplayer_playlist_view_set(Enna_Playlist *enna_playlist,
+                                        Enna_File_Array *files);
 void enna_mediaplayer_send_input(enna_input event);
 int enna_mediaplayer_volume_get(void);
 void enna_mediaplayer_volume_set(int volume);
@@ -1,12 +1,18 @@
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
 #include <Emotion.h>
 #include "utils.h"
 #include "logs.h"
 #include "mediaplayer.h"
 #include "mediaplayer_obj.h"
 #include "enna_config.h"
+#include "readahead.h"
 
 #define SEEK_STEP_DEFAULT         10 /* seconds */
 #define VOLUME_STEP_DEFAULT       5 /* percent */
+#define PRELOAD_DEFAULT           5 /* seconds before the end of a track */
 
 typedef struct _Enna_Mediaplayer Enna_Mediaplayer;
 
@@ -14,6 +20,11 @@ struct _Enna_Mediaplayer
 {
     PLAY_STATE play_state;
     Evas_Object *player;
+    /* gapless playback: player is one of them, the other one opens the
+     * next track of the playlist before the end of the current one */
+    Evas_Object *players[2];
+    Enna_File *preloaded;
+    int preloaded_index;
     void (*event_cb)(void *data, enna_mediaplayer_event_t event);
     void *event_cb_data;
     char *uri;
@@ -31,6 +42,8 @@ struct _Enna_Mediaplayer
 
 typedef struct mediaplayer_cfg_s {
     char *engine;
+    Eina_Bool gapless;
+    int preload;
 } mediaplayer_cfg_t;
 
 static mediaplayer_cfg_t mp_cfg;
@@ -71,6 +84,17 @@ cfg_mediaplayer_section_load (const char *section)
             }
         }
     }
+
+    value = enna_config_string_get(section, "gapless");
+    if (value)
+    {
+        mp_cfg.gapless = enna_config_bool_get(section, "gapless");
+        enna_log(ENNA_MSG_INFO, NULL, " * gapless: %s", value);
+    }
+
+    i = enna_config_int_get(section, "preload");
+    if (i > 0)
+        mp_cfg.preload = i;
 }
 
 static void
@@ -88,6 +112,9 @@ cfg_mediaplayer_section_save (const char *section)
             break;
         }
     }
+
+    enna_config_bool_set(section, "gapless", mp_cfg.gapless);
+    enna_config_int_set(section, "preload", mp_cfg.preload);
 }
 
 static void
@@ -102,6 +129,8 @@ cfg_mediaplayer_section_set_default (void)
     cfg_mediaplayer_free();
 
     mp_cfg.engine           = strdup("xine");
+    mp_cfg.gapless          = EINA_TRUE;
+    mp_cfg.preload          = PRELOAD_DEFAULT;
 }
 
 static Enna_Config_Section_Parser cfg_mediaplayer = {
@@ -112,6 +141,240 @@ static Enna_Config_Section_Parser cfg_mediaplayer = {
     cfg_mediaplayer_free,
 };
 
+/* Playlist array */
+
+static Enna_File *
+_playlist_file_get(Enna_Playlist *pl, int position)
+{
+    if (!pl || position < 0 || position >= pl->count)
+        return NULL;
+
+    return pl->files[pl->order ? pl->order[position] : position];
+}
+
+/* Play position following the selected one, -1 at the end */
+static int
+_playlist_next_get(Enna_Playlist *pl)
+{
+    if (pl->selected + 1 < pl->count)
+        return pl->selected + 1;
+
+    return (pl->repeat && pl->count) ? 0 : -1;
+}
+
+/* Trade the shared array of a view playlist for a private copy */
+static Eina_Bool
+_playlist_detach(Enna_Playlist *pl)
+{
+    Enna_File **files = NULL;
+    int i;
+
+    if (!pl->view)
+        return EINA_TRUE;
+
+    if (pl->count)
+    {
+        files = malloc(pl->count * sizeof(Enna_File *));
+        if (!files)
+            return EINA_FALSE;
+        for (i = 0; i < pl->count; i++)
+            files[i] = enna_file_ref(pl->files[i]);
+    }
+
+    enna_file_array_unref(pl->view);
+    pl->view = NULL;
+    pl->files = files;
+    pl->size = pl->count;
+    return EINA_TRUE;
+}
+
+static Eina_Bool
+_playlist_grow(Enna_Playlist *pl)
+{
+    Enna_File **files;
+    int *order = NULL, *pos = NULL;
+    int size;
+
+    if (pl->count < pl->size)
+        return EINA_TRUE;
+
+    size = pl->size ? pl->size * 2 : 64;
+    files = realloc(pl->files, size * sizeof(Enna_File *));
+    if (!files)
+        return EINA_FALSE;
+    pl->files = files;
+
+    if (pl->shuffle)
+    {
+        order = realloc(pl->order, size * sizeof(int));
+        if (order)
+            pl->order = order;
+        pos = realloc(pl->pos, size * sizeof(int));
+        if (pos)
+            pl->pos = pos;
+        if (!order || !pos)
+            return EINA_FALSE;
+    }
+
+    pl->size = size;
+    return EINA_TRUE;
+}
+
+/* Fisher-Yates, the current file is moved to the first position so that
+ * enabling shuffle does not change the track being played. */
+static void
+_playlist_shuffle(Enna_Playlist *pl, int current)
+{
+    int i, j, tmp;
+
+    for (i = 0; i < pl->count; i++)
+        pl->order[i] = i;
+
+    for (i = pl->count - 1; i > 0; i--)
+    {
+        j = rand() % (i + 1);
+        tmp = pl->order[i];
+        pl->order[i] = pl->order[j];
+        pl->order[j] = tmp;
+    }
+
+    for (i = 0; i < pl->count; i++)
+        pl->pos[pl->order[i]] = i;
+
+    if (current >= 0 && current < pl->count)
+    {
+        i = pl->pos[current];
+        pl->order[i] = pl->order[0];
+        pl->order[0] = current;
+        pl->pos[pl->order[i]] = i;
+        pl->pos[current] = 0;
+    }
+    pl->selected = 0;
+}
+
+static Evas_Object *
+_player_spare_get(void)
+{
+    return mp->players[0] == mp->player ? mp->players[1] : mp->players[0];
+}
+
+static void
+_preload_cancel(void)
+{
+    if (!mp->preloaded)
+        return;
+
+    emotion_object_file_set(_player_spare_get(), NULL);
+    enna_file_free(mp->preloaded);
+    mp->preloaded = NULL;
+}
+
+/* Open the next track in the spare player, paused, so that switching to it
+ * does not wait for the decoder. Videos are not preloaded. */
+static void
+_preload_next(void)
+{
+    Enna_Playlist *pl = mp->cur_playlist;
+    Enna_File *cur, *next;
+    Evas_Object *spare;
+
+    if (!pl)
+        return;
+
+    cur = _playlist_file_get(pl, pl->selected);
+    next = _playlist_file_get(pl, _playlist_next_get(pl));
+    if (!cur || !next || cur->type == ENNA_FILE_FILM ||
+        next->type == ENNA_FILE_FILM || !enna_file_mrl_get(next))
+        return;
+
+    spare = _player_spare_get();
+    emotion_object_file_set(spare, enna_file_mrl_get(next));
+    emotion_object_play_set(spare, EINA_FALSE);
+    mp->preloaded = enna_file_ref(next);
+    mp->preloaded_index = _playlist_next_get(pl);
+
+    enna_log(ENNA_MSG_EVENT, NULL, "preload %d", mp->preloaded_index);
+}
+
+/* Switch to the preloaded player if it holds the selected track */
+static Eina_Bool
+_preload_swap(Enna_Playlist *enna_playlist)
+{
+    Evas_Object *old;
+
+    if (!mp->preloaded || enna_playlist != mp->cur_playlist ||
+        enna_playlist->selected != mp->preloaded_index ||
+        _playlist_file_get(enna_playlist, enna_playlist->selected)
+        != mp->preloaded)
+        return EINA_FALSE;
+
+    old = mp->player;
+    mp->player = _player_spare_get();
+    emotion_object_audio_volume_set(mp->player,
+                                    emotion_object_audio_volume_get(old));
+    emotion_object_audio_mute_set(mp->player,
+                                  emotion_object_audio_mute_get(old));
+    emotion_object_play_set(mp->player, EINA_TRUE);
+    enna_readahead_start(enna_file_mrl_get(mp->preloaded));
+
+    /* release the decoder of the track which just ended */
+    emotion_object_play_set(old, EINA_FALSE);
+    emotion_object_file_set(old, NULL);
+
+    enna_file_free(mp->preloaded);
+    mp->preloaded = NULL;
+    mp->play_state = PLAYING;
+
+    return EINA_TRUE;
+}
+
+static void
+_player_position_update_cb(void *data EINA_UNUSED, Evas_Object *obj,
+                           void *event_info EINA_UNUSED)
+{
+    double len;
+
+    if (obj != mp->player)
+        return;
+
+    ecore_event_add(ENNA_EVENT_MEDIAPLAYER_POSITION, NULL, NULL, NULL);
+    enna_readahead_update(emotion_object_position_get(obj),
+                          emotion_object_play_length_get(obj));
+
+    if (!mp_cfg.gapless || mp->preloaded || mp->play_state != PLAYING)
+        return;
+
+    len = emotion_object_play_length_get(obj);
+    if (len > 0.0 &&
+        len - emotion_object_position_get(obj) <= mp_cfg.preload)
+        _preload_next();
+}
+
+static void
+_player_playback_finished_cb(void *data EINA_UNUSED, Evas_Object *obj,
+                             void *event_info EINA_UNUSED)
+{
+    if (obj != mp->player || mp->play_state != PLAYING)
+        return;
+
+    ecore_event_add(ENNA_EVENT_MEDIAPLAYER_EOS, NULL, NULL, NULL);
+}
+
+static Evas_Object *
+_player_add(void)
+{
+    Evas_Object *o;
+
+    o = emotion_object_add(evas_object_evas_get(enna->layout));
+    emotion_object_init(o, mp->engine);
+    evas_object_layer_set(o, -1);
+    evas_object_smart_callback_add(o, "playback_finished",
+                                   _player_playback_finished_cb, NULL);
+    evas_object_smart_callback_add(o, "position_update",
+                                   _player_position_update_cb, NULL);
+    return o;
+}
+
 /* externally accessible functions */
 int
 enna_mediaplayer_supported_uri_type(enna_mediaplayer_uri_type_t type EINA_UNUSED)
@@ -135,10 +398,12 @@ enna_mediaplayer_init(void)
     mp->label = NULL;
 
     mp->engine = strdup(mp_cfg.engine);
-    mp->player = emotion_object_add(evas_object_evas_get(enna->layout));
-    emotion_object_init(mp->player, mp->engine);
-    evas_object_layer_set(mp->player, -1);
+    mp->players[0] = _player_add();
+    if (mp_cfg.gapless)
+        mp->players[1] = _player_add();
+    mp->player = mp->players[0];
     mp->play_state = STOPPED;
+    srand(time(NULL)); /* playlists shuffle */
 
     /* Create Ecore Event ID */
     ENNA_EVENT_MEDIAPLAYER_EOS = ecore_event_type_new();
@@ -150,6 +415,7 @@ enna_mediaplayer_init(void)
     ENNA_EVENT_MEDIAPLAYER_PREV = ecore_event_type_new();
     ENNA_EVENT_MEDIAPLAYER_NEXT = ecore_event_type_new();
     ENNA_EVENT_MEDIAPLAYER_SEEK = ecore_event_type_new();
+    ENNA_EVENT_MEDIAPLAYER_POSITION = ecore_event_type_new();
 
     return 1;
 }
@@ -163,9 +429,13 @@ enna_mediaplayer_shutdown(void)
     ENNA_FREE(mp->uri);
     ENNA_FREE(mp->label);
     ENNA_FREE(mp->engine);
+    _preload_cancel();
+    enna_readahead_stop();
     emotion_object_play_set(mp->player, EINA_FALSE);
-    if (mp->player)
-        evas_object_del(mp->player);
+    if (mp->players[0])
+        evas_object_del(mp->players[0]);
+    if (mp->players[1])
+        evas_object_del(mp->players[1]);
     ENNA_FREE(mp);
 }
 
@@ -182,7 +452,7 @@ enna_mediaplayer_current_file_get(void)
     if (!mp->cur_playlist || mp->play_state != PLAYING)
         return NULL;
 
-    item = eina_list_nth(mp->cur_playlist->playlist, mp->cur_playlist->selected);
+    item = _playlist_file_get(mp->cur_playlist, mp->cur_playlist->selected);
     if (!item)
         return NULL;
 
@@ -197,19 +467,122 @@ enna_mediaplayer_get_current_uri(void)
   if (!mp->cur_playlist || mp->play_state != PLAYING)
       return NULL;
 
-  item = eina_list_nth(mp->cur_playlist->playlist, mp->cur_playlist->selected);
-  if (!item->uri)
+  item = _playlist_file_get(mp->cur_playlist, mp->cur_playlist->selected);
+  if (!enna_file_uri_get(item))
     return NULL;
 
-  return strdup(item->uri);
+  return strdup(enna_file_uri_get(item));
 }
 
 void
 enna_mediaplayer_file_append(Enna_Playlist *enna_playlist, Enna_File *file)
 {
-    Enna_File *f;
-    f = enna_file_ref(file);
-    enna_playlist->playlist = eina_list_append(enna_playlist->playlist, f);
+    Enna_Playlist *pl = enna_playlist;
+
+    if (!file || !_playlist_detach(pl) || !_playlist_grow(pl))
+        return;
+
+    pl->files[pl->count] = enna_file_ref(file);
+    if (pl->shuffle)
+    {
+        pl->order[pl->count] = pl->count;
+        pl->pos[pl->count] = pl->count;
+    }
+    pl->count++;
+}
+
+/* Insert the file so that it is played right after the selected one */
+void
+enna_mediaplayer_file_play_next(Enna_Playlist *enna_playlist, Enna_File *file)
+{
+    Enna_Playlist *pl = enna_playlist;
+    int at, i;
+
+    if (!file || !_playlist_detach(pl) || !_playlist_grow(pl))
+        return;
+
+    at = pl->count ? pl->selected + 1 : 0;
+    if (!pl->shuffle)
+    {
+        memmove(pl->files + at + 1, pl->files + at,
+                (pl->count - at) * sizeof(Enna_File *));
+        pl->files[at] = enna_file_ref(file);
+    }
+    else
+    {
+        /* the file goes at the end of the array, only its play position
+         * is inserted */
+        pl->files[pl->count] = enna_file_ref(file);
+        memmove(pl->order + at + 1, pl->order + at,
+                (pl->count - at) * sizeof(int));
+        pl->order[at] = pl->count;
+        for (i = at; i <= pl->count; i++)
+            pl->pos[pl->order[i]] = i;
+    }
+    pl->count++;
+
+    /* the preloaded track is not the next one anymore */
+    if (pl == mp->cur_playlist)
+        _preload_cancel();
+}
+
+void
+enna_mediaplayer_shuffle_set(Enna_Playlist *enna_playlist, Eina_Bool shuffle)
+{
+    Enna_Playlist *pl = enna_playlist;
+
+    if (!pl || pl->shuffle == !!shuffle)
+        return;
+
+    if (pl == mp->cur_playlist)
+        _preload_cancel();
+
+    if (shuffle)
+    {
+        int size = pl->size ? pl->size : 1;
+
+        pl->order = malloc(size * sizeof(int));
+        pl->pos = malloc(size * sizeof(int));
+        if (!pl->order || !pl->pos)
+        {
+            ENNA_FREE(pl->order);
+            ENNA_FREE(pl->pos);
+            return;
+        }
+        pl->shuffle = EINA_TRUE;
+        _playlist_shuffle(pl, pl->selected);
+    }
+    else
+    {
+        if (pl->count)
+            pl->selected = pl->order[pl->selected];
+        ENNA_FREE(pl->order);
+        ENNA_FREE(pl->pos);
+        pl->shuffle = EINA_FALSE;
+    }
+}
+
+Eina_Bool
+enna_mediaplayer_shuffle_get(Enna_Playlist *enna_playlist)
+{
+    return enna_playlist ? enna_playlist->shuffle : EINA_FALSE;
+}
+
+void
+enna_mediaplayer_repeat_set(Enna_Playlist *enna_playlist, Eina_Bool repeat)
+{
+    if (!enna_playlist)
+        return;
+
+    enna_playlist->repeat = !!repeat;
+    if (enna_playlist == mp->cur_playlist)
+        _preload_cancel();
+}
+
+Eina_Bool
+enna_mediaplayer_repeat_get(Enna_Playlist *enna_playlist)
+{
+    return enna_playlist ? enna_playlist->repeat : EINA_FALSE;
 }
 
 int
@@ -222,11 +595,13 @@ enna_mediaplayer_play(Enna_Playlist *enna_playlist)
     case STOPPED:
     {
       Enna_File *item;
-        item = eina_list_nth(enna_playlist->playlist,
-                             enna_playlist->selected);
+        item = _playlist_file_get(enna_playlist, enna_playlist->selected);
         emotion_object_play_set(mp->player, EINA_FALSE);
-        if (item && item->uri)
-            emotion_object_file_set(mp->player, item->mrl);
+        if (item && enna_file_mrl_get(item))
+        {
+            emotion_object_file_set(mp->player, enna_file_mrl_get(item));
+            enna_readahead_start(enna_file_mrl_get(item));
+        }
         emotion_object_play_set(mp->player, EINA_TRUE);
         if (item && item->type == ENNA_FILE_FILM)
         {
@@ -253,14 +628,16 @@ enna_mediaplayer_play(Enna_Playlist *enna_playlist)
     return 0;
 }
 
+/* n and the returned index are in the order the files were added */
 int
 enna_mediaplayer_select_nth(Enna_Playlist *enna_playlist, int n)
 {
-  if (n < 0 || (unsigned int)n > eina_list_count(enna_playlist->playlist) - 1)
+    if (n < 0 || n >= enna_playlist->count)
         return -1;
 
     enna_log(ENNA_MSG_EVENT, NULL, "select %d", n);
-    enna_playlist->selected = n;
+    enna_playlist->selected =
+        enna_playlist->pos ? enna_playlist->pos[n] : n;
 
     return 0;
 }
@@ -268,12 +645,16 @@ enna_mediaplayer_select_nth(Enna_Playlist *enna_playlist, int n)
 int
 enna_mediaplayer_selected_get(Enna_Playlist *enna_playlist)
 {
+    if (enna_playlist->order && enna_playlist->count)
+        return enna_playlist->order[enna_playlist->selected];
     return enna_playlist->selected;
 }
 
 int
 enna_mediaplayer_stop(void)
 {
+    _preload_cancel();
+    enna_readahead_stop();
     emotion_object_play_set(mp->player, EINA_FALSE);
     emotion_object_position_set(mp->player, 0);
     mp->play_state = STOPPED;
@@ -299,11 +680,18 @@ enna_mediaplayer_change(Enna_Playlist *enna_playlist, int type)
 {
     Enna_File *item;
 
-    item = eina_list_nth(enna_playlist->playlist, enna_playlist->selected);
+    item = _playlist_file_get(enna_playlist, enna_playlist->selected);
     enna_log(ENNA_MSG_EVENT, NULL, "select %d", enna_playlist->selected);
     if (!item)
         return;
 
+    if (_preload_swap(enna_playlist))
+    {
+        ecore_event_add(ENNA_EVENT_MEDIAPLAYER_START, NULL, NULL, NULL);
+        ecore_event_add(type, NULL, NULL, NULL);
+        return;
+    }
+
     enna_mediaplayer_stop();
     enna_mediaplayer_play(enna_playlist);
     ecore_event_add(type, NULL, NULL, NULL);
@@ -312,13 +700,12 @@ enna_mediaplayer_change(Enna_Playlist *enna_playlist, int type)
 int
 enna_mediaplayer_next(Enna_Playlist *enna_playlist)
 {
-    enna_playlist->selected++;
-    if ((unsigned int)enna_playlist->selected >
-       eina_list_count(enna_playlist->playlist) - 1)
-    {
-        enna_playlist->selected--;
+    int next;
+
+    next = _playlist_next_get(enna_playlist);
+    if (next < 0)
         return -1;
-    }
+    enna_playlist->selected = next;
 
     enna_mediaplayer_change(enna_playlist, ENNA_EVENT_MEDIAPLAYER_NEXT);
     return 0;
@@ -327,12 +714,12 @@ enna_mediaplayer_next(Enna_Playlist *enna_playlist)
 int
 enna_mediaplayer_prev(Enna_Playlist *enna_playlist)
 {
-    enna_playlist->selected--;
-    if (enna_playlist->selected < 0)
-    {
-        enna_playlist->selected = 0;
+    if (enna_playlist->selected > 0)
+        enna_playlist->selected--;
+    else if (enna_playlist->repeat && enna_playlist->count)
+        enna_playlist->selected = enna_playlist->count - 1;
+    else
         return -1;
-    }
 
     enna_mediaplayer_change(enna_playlist, ENNA_EVENT_MEDIAPLAYER_PREV);
     return 0;
@@ -440,16 +827,60 @@ enna_mediaplayer_video_resize(int x, int y, int w, int h)
     evas_object_move(mp->player, x, y);
 }
 
+static void
+_playlist_load_add_cb(void *data, Enna_File *file)
+{
+    enna_mediaplayer_file_append(data, file);
+}
+
+static void
+_playlist_load_done_cb(void *data, int count EINA_UNUSED)
+{
+    Enna_Playlist *enna_playlist = data;
+
+    enna_playlist->loader = NULL;
+}
+
+/* Entries are appended from the main loop while the file is read */
 int
-enna_mediaplayer_playlist_load(const char *filename EINA_UNUSED)
+enna_mediaplayer_playlist_load(Enna_Playlist *enna_playlist,
+                               const char *filename)
 {
-    return 0;
+    if (!enna_playlist || !filename)
+        return -1;
+
+    enna_playlist_file_load_cancel(enna_playlist->loader);
+    enna_playlist->loader =
+        enna_playlist_file_load(filename, _playlist_load_add_cb,
+                                _playlist_load_done_cb, enna_playlist);
+
+    return enna_playlist->loader ? 0 : -1;
 }
 
 int
-enna_mediaplayer_playlist_save(const char *filename EINA_UNUSED)
+enna_mediaplayer_playlist_save(Enna_Playlist *enna_playlist,
+                               const char *filename)
 {
-    return 0;
+    Enna_File **files;
+    int i, ret;
+
+    if (!enna_playlist || !filename)
+        return -1;
+
+    if (!enna_playlist->order || !enna_playlist->count)
+        return enna_playlist_file_save(filename, enna_playlist->files,
+                                       enna_playlist->count);
+
+    /* shuffled, save the play order */
+    files = malloc(enna_playlist->count * sizeof(Enna_File *));
+    if (!files)
+        return -1;
+    for (i = 0; i < enna_playlist->count; i++)
+        files[i] = enna_playlist->files[enna_playlist->order[i]];
+    ret = enna_playlist_file_save(filename, files, enna_playlist->count);
+    free(files);
+
+    return ret;
 }
 
 
@@ -457,11 +888,25 @@ enna_mediaplayer_playlist_save(const char *filename EINA_UNUSED)
 void
 enna_mediaplayer_playlist_clear(Enna_Playlist *enna_playlist)
 {
-    Enna_File *f;
+    int i;
 
-    EINA_LIST_FREE(enna_playlist->playlist, f)
-        enna_file_free(f);
-    enna_playlist->playlist = NULL;
+    enna_playlist_file_load_cancel(enna_playlist->loader);
+    enna_playlist->loader = NULL;
+    if (enna_playlist == mp->cur_playlist)
+        _preload_cancel();
+    if (enna_playlist->view)
+    {
+        enna_file_array_unref(enna_playlist->view);
+        enna_playlist->view = NULL;
+        enna_playlist->files = NULL;
+        enna_playlist->size = 0;
+    }
+    else
+    {
+        for (i = 0; i < enna_playlist->count; i++)
+            enna_file_free(enna_playlist->files[i]);
+    }
+    enna_playlist->count = 0;
     enna_playlist->selected = 0;
 }
 
@@ -470,12 +915,12 @@ enna_mediaplayer_metadata_get(Enna_Playlist *enna_playlist)
 {
     Enna_File *item;
 
-    item = eina_list_nth(enna_playlist->playlist, enna_playlist->selected);
+    item = _playlist_file_get(enna_playlist, enna_playlist->selected);
     if (!item)
         return NULL;
 
-    if (item->uri)
-        return enna_metadata_meta_new((char *) item->mrl);
+    if (enna_file_mrl_get(item))
+        return enna_metadata_meta_new((char *) enna_file_mrl_get(item));
 
     return NULL;
 }
@@ -483,7 +928,7 @@ enna_mediaplayer_metadata_get(Enna_Playlist *enna_playlist)
 int
 enna_mediaplayer_playlist_count(Enna_Playlist *enna_playlist)
 {
-    return eina_list_count(enna_playlist->playlist);
+    return enna_playlist->count;
 }
 
 PLAY_STATE
@@ -499,14 +944,18 @@ enna_mediaplayer_playlist_create(void)
 
     enna_playlist = calloc(1, sizeof(Enna_Playlist));
     enna_playlist->selected = 0;
-    enna_playlist->playlist = NULL;
     return enna_playlist;
 }
 
 void
 enna_mediaplayer_playlist_free(Enna_Playlist *enna_playlist)
 {
-    eina_list_free(enna_playlist->playlist);
+    enna_mediaplayer_playlist_clear(enna_playlist);
+    if (enna_playlist == mp->cur_playlist)
+        mp->cur_playlist = NULL;
+    free(enna_playlist->files);
+    free(enna_playlist->order);
+    free(enna_playlist->pos);
     free(enna_playlist);
 }
 
@@ -514,12 +963,53 @@ void
 enna_mediaplayer_playlist_stop_clear(Enna_Playlist *enna_playlist)
 {
     enna_mediaplayer_playlist_clear(enna_playlist);
+    enna_readahead_stop();
     emotion_object_play_set(mp->player, EINA_FALSE);
     emotion_object_position_set(mp->player, 0);
     mp->play_state = STOPPED;
     ecore_event_add(ENNA_EVENT_MEDIAPLAYER_STOP, NULL, NULL, NULL);
 }
 
+/* Play the files of the array without copying them, in O(1) unless
+ * shuffle is on */
+void
+enna_mediaplayer_playlist_view_set(Enna_Playlist *enna_playlist,
+                                   Enna_File_Array *files)
+{
+    Enna_Playlist *pl = enna_playlist;
+
+    if (!pl)
+        return;
+
+    enna_mediaplayer_playlist_clear(pl);
+    if (!files || !files->count)
+        return;
+
+    if (pl->shuffle)
+    {
+        int *order, *pos;
+
+        order = realloc(pl->order, files->count * sizeof(int));
+        if (order)
+            pl->order = order;
+        pos = realloc(pl->pos, files->count * sizeof(int));
+        if (pos)
+            pl->pos = pos;
+        if (!order || !pos)
+            return;
+    }
+
+    /* the emptied private array is not needed anymore */
+    free(pl->files);
+    pl->view = enna_file_array_ref(files);
+    pl->files = files->files;
+    pl->count = files->count;
+    pl->size = files->count;
+
+    if (pl->shuffle)
+        _playlist_shuffle(pl, -1);
+}
+
 void
 enna_mediaplayer_send_input(enna_input event EINA_UNUSED)
 {
@@ -27,10 +27,14 @@
 #include "mediaplayer.h"
 #include "mediaplayer_obj.h"
 #include "utils.h"
+#include "artwork.h"
 #include "logs.h"
 
 #define SMART_NAME "mediaplayer_obj"
 
+/* smallest slider move worth a redraw, in percent */
+#define SLIDER_STEP 0.1
+
 typedef struct _Mediaplayer_Events Mediaplayer_Events;
 
 static struct _Mediaplayer_Events
@@ -60,11 +64,15 @@ struct _Smart_Data
     Evas_Object *btn_box;
     Evas_Object *text_box;
     Eina_List *buttons;
-    Ecore_Timer *timer;
+    Ecore_Event_Handler *position_handler;
+    Ecore_Animator *position_animator;
     double pos;
     double len;
+    double slider_value;
+    char pos_str[32];           /* last texts set, to skip identical ones */
+    char len_str[32];
     unsigned char show : 1;
-    unsigned char update : 1;
+    unsigned char seeking : 1;  /* slider being dragged */
     Enna_Playlist *playlist;
 };
 
@@ -87,7 +95,7 @@ static Eina_Bool _eos_cb(void *data, int type, void *event);
 static void show_play_button(Smart_Data * sd);
 static void show_pause_button(Smart_Data * sd);
 
-static Eina_Bool _timer_cb(void *data);
+static void _position_reset(Smart_Data *sd);
 
 #define METADATA_APPLY                                              \
     do                                                              \
@@ -158,6 +166,7 @@ _metadata_set(Evas_Object *obj, Enna_Metadata *metadata EINA_UNUSED, Enna_File *
     if (cover)
     {
         char cv[1024] = { 0 };
+        const char *art;
 
         if (*cover == '/')
             snprintf(cv, sizeof(cv), "%s", cover);
@@ -165,7 +174,10 @@ _metadata_set(Evas_Object *obj, Enna_Metadata *metadata EINA_UNUSED, Enna_File *
             snprintf(cv, sizeof(cv), "%s/covers/%s",
                      enna_util_data_home_get(), cover);
 
-        elm_image_file_set(sd->cv, cv, NULL);
+        art = enna_artwork_get(cv, ENNA_ARTWORK_PANEL);
+        elm_image_file_set(sd->cv, art, NULL);
+        eina_stringshare_del(art);
+        eina_stringshare_del(cover);
     }
     else
     {
@@ -201,9 +213,8 @@ _start_cb(void *data, int type EINA_UNUSED, void *event EINA_UNUSED)
     enna_log(ENNA_MSG_EVENT, NULL, "Media control Event PLAY ");
     METADATA_APPLY;
     edje_object_signal_emit(elm_layout_edje_get(sd->layout), "controls,show", "enna");
-    ENNA_TIMER_DEL(sd->timer);
-    sd->timer = ecore_timer_add(1, _timer_cb, sd);
-    sd->pos = 0.0;
+    /* a gapless switch sends START without STOP */
+    _position_reset(sd);
     sd->show = 1;
     return 1;
 }
@@ -215,8 +226,7 @@ _stop_cb(void *data, int type EINA_UNUSED, void *event EINA_UNUSED)
 
     enna_log(ENNA_MSG_EVENT, NULL, "Media control Event STOP ");
     edje_object_signal_emit(elm_layout_edje_get(sd->layout), "controls,hide", "enna");
-    sd->pos = 0.0;
-    sd->len = 0.0;
+    _position_reset(sd);
     media_cover_hide(sd);
     sd->show = 0;
     return 1;
@@ -279,61 +289,113 @@ _eos_cb(void *data, int type EINA_UNUSED, void *event EINA_UNUSED)
     return 1;
 }
 
-#define SNPRINTF_TIME(buf, h, m, s) \
-    snprintf(buf, sizeof(buf), "%.0li%c%02li:%02li", h, h ? ':' : ' ', m, s)
-
 static void
-slider_position_update(Smart_Data *sd)
-{
-    long ph, pm, ps, lh, lm, ls;
-    char buf[256];
-    char buf2[256];
-
-    /* FIXME : create a dedicated function to do that */
-    lh = sd->len / 3600;
-    lm = sd->len / 60 - (lh * 60);
-    ls = sd->len - (lm * 60) - lh * 3600;
-    ph = sd->pos / 3600;
-    pm = sd->pos / 60 - (ph * 60);
-    ps = sd->pos - (pm * 60) - ph * 3600;
-    SNPRINTF_TIME(buf,  ph, pm, ps);
-    SNPRINTF_TIME(buf2, lh, lm, ls);
-
-    edje_object_part_text_set(elm_layout_edje_get(sd->layout), "text.length", buf2);
-    edje_object_part_text_set(elm_layout_edje_get(sd->layout), "text.pos", buf);
-
-    if (sd->len)
-    {
-        elm_slider_value_set(sd->sl, sd->pos/sd->len * 100.0);
-        if(sd->pos > sd->len)
-            ecore_event_add(ENNA_EVENT_MEDIAPLAYER_EOS, NULL, NULL, NULL);
-    }
-    enna_log(ENNA_MSG_EVENT, NULL, "Position %f %f", sd->pos, sd->len);
+_time_format(char *buf, size_t size, double t)
+{
+    long h, m, sec;
+
+    h = t / 3600;
+    m = t / 60 - (h * 60);
+    sec = t - (m * 60) - h * 3600;
+    snprintf(buf, size, "%.0li%c%02li:%02li", h, h ? ':' : ' ', m, sec);
 }
 
-/* Update position Timer callback */
-static Eina_Bool
-_timer_cb(void *data)
+/* Only the parts whose text or value really changed are updated */
+static void
+_position_refresh(Smart_Data *sd)
 {
-    Smart_Data *sd = data;
+    Evas_Object *edje;
+    char buf[32];
+    double value;
 
     //Wait the "length_change" signal in emotion
-    if(!sd->len)
+    if (!sd->len)
         sd->len = enna_mediaplayer_length_get();
+    sd->pos = enna_mediaplayer_position_get();
 
-    if(sd->update)
+    edje = elm_layout_edje_get(sd->layout);
+
+    _time_format(buf, sizeof(buf), sd->len);
+    if (strcmp(buf, sd->len_str))
     {
-        sd->update = 0;
-        sd->pos = enna_mediaplayer_position_get();
+        strcpy(sd->len_str, buf);
+        edje_object_part_text_set(edje, "text.length", buf);
     }
 
-    if(enna_mediaplayer_state_get() == PLAYING)
+    _time_format(buf, sizeof(buf), sd->pos);
+    if (strcmp(buf, sd->pos_str))
     {
-        sd->pos += 1.0;
-        slider_position_update(sd);
+        strcpy(sd->pos_str, buf);
+        edje_object_part_text_set(edje, "text.pos", buf);
     }
 
-    return 1;
+    /* EOS is sent by the mediaplayer once the stream really ends */
+    if (sd->len && !sd->seeking)
+    {
+        value = sd->pos / sd->len * 100.0;
+        if (value - sd->slider_value >= SLIDER_STEP ||
+            sd->slider_value - value >= SLIDER_STEP)
+        {
+            sd->slider_value = value;
+            elm_slider_value_set(sd->sl, value);
+        }
+    }
+}
+
+static void
+_position_reset(Smart_Data *sd)
+{
+    sd->pos = 0.0;
+    sd->len = 0.0;
+    sd->slider_value = -1.0;
+    sd->pos_str[0] = '\0';
+    sd->len_str[0] = '\0';
+}
+
+/* One refresh per frame at most, whatever the rate of the stream updates */
+static Eina_Bool
+_position_animator_cb(void *data)
+{
+    Smart_Data *sd = data;
+
+    sd->position_animator = NULL;
+    _position_refresh(sd);
+    return ECORE_CALLBACK_CANCEL;
+}
+
+static Eina_Bool
+_position_cb(void *data, int type EINA_UNUSED, void *event EINA_UNUSED)
+{
+    Smart_Data *sd = data;
+
+    if (!sd->position_animator && !sd->seeking)
+        sd->position_animator = ecore_animator_add(_position_animator_cb, sd);
+    return ECORE_CALLBACK_PASS_ON;
+}
+
+/* The position is only tracked while the controls are visible */
+static void
+_layout_show_cb(void *data, Evas *e EINA_UNUSED, Evas_Object *obj EINA_UNUSED, void *event_info EINA_UNUSED)
+{
+    Smart_Data *sd = data;
+
+    if (!sd->position_handler)
+        sd->position_handler =
+            ecore_event_handler_add(ENNA_EVENT_MEDIAPLAYER_POSITION,
+                                    _position_cb, sd);
+    if (enna_mediaplayer_state_get() != STOPPED)
+        _position_refresh(sd);
+}
+
+static void
+_layout_hide_cb(void *data, Evas *e EINA_UNUSED, Evas_Object *obj EINA_UNUSED, void *event_info EINA_UNUSED)
+{
+    Smart_Data *sd = data;
+
+    ENNA_EVENT_HANDLER_DEL(sd->position_handler);
+    if (sd->position_animator)
+        ecore_animator_del(sd->position_animator);
+    sd->position_animator = NULL;
 }
 
 /* events from buttons*/
@@ -354,21 +416,15 @@ _button_clicked_prev_cb(void *data, Evas_Object *obj EINA_UNUSED, void *event_in
 }
 
 static void
-_button_clicked_rewind_cb(void *data, Evas_Object *obj EINA_UNUSED, void *event_info EINA_UNUSED)
+_button_clicked_rewind_cb(void *data EINA_UNUSED, Evas_Object *obj EINA_UNUSED, void *event_info EINA_UNUSED)
 {
-    Smart_Data *sd = data;
-
     enna_mediaplayer_default_seek_backward();
-    sd->update = 1;
 }
 
 static void
-_button_clicked_forward_cb(void *data, Evas_Object *obj EINA_UNUSED, void *event_info EINA_UNUSED)
+_button_clicked_forward_cb(void *data EINA_UNUSED, Evas_Object *obj EINA_UNUSED, void *event_info EINA_UNUSED)
 {
-    Smart_Data *sd = data;
-
     enna_mediaplayer_default_seek_forward();
-    sd->update = 1;
 }
 
 static void
@@ -402,15 +458,15 @@ _slider_seek_cb(void *data, Evas_Object *obj EINA_UNUSED, void *event_info EINA_
 
     value = elm_slider_value_get(sd->sl);
     enna_mediaplayer_seek_percent((int) value);
-    sd->update = 1;
-    ecore_timer_thaw(sd->timer);
+    sd->slider_value = value;
+    sd->seeking = 0;
 }
 
 static void
 _slider_start_cb(void *data, Evas_Object *obj EINA_UNUSED, void *event_info EINA_UNUSED)
 {
     Smart_Data *sd = data;
-    ecore_timer_freeze(sd->timer);
+    sd->seeking = 1;
 }
 
 static void
@@ -518,7 +574,7 @@ _del_cb(void *data, Evas *e EINA_UNUSED, Evas_Object *obj EINA_UNUSED, void *eve
     ENNA_OBJECT_DEL(sd->btn_box);
     ENNA_OBJECT_DEL(sd->text_box);
     eina_list_free(sd->buttons);
-    ENNA_TIMER_DEL(sd->timer);
+    _layout_hide_cb(sd, NULL, NULL, NULL);
     free(sd);
 }
 
@@ -675,9 +731,13 @@ enna_mediaplayer_obj_add(Evas * evas EINA_UNUSED, Enna_Playlist *enna_playlist)
     elm_layout_content_set(layout, "slider.swallow", sl);
 
     evas_object_event_callback_add(layout, EVAS_CALLBACK_DEL, _del_cb, sd);
+    evas_object_event_callback_add(layout, EVAS_CALLBACK_SHOW,
+                                   _layout_show_cb, sd);
+    evas_object_event_callback_add(layout, EVAS_CALLBACK_HIDE,
+                                   _layout_hide_cb, sd);
 
     sd->playlist = enna_playlist;
-    sd->len = 0;
+    _position_reset(sd);
 
     evas_object_data_set(layout, "sd", sd);
 
@@ -732,6 +792,5 @@ void
 enna_mediaplayer_position_update(Evas_Object *obj)
 {
     Smart_Data *sd = evas_object_data_get(obj, "sd");
-    sd->pos = enna_mediaplayer_position_get();
-    slider_position_update(sd);
+    _position_refresh(sd);
 }
@@ -36,6 +36,8 @@
 #include "logs.h"
 #include "utils.h"
 #include "buffer.h"
+#include "trace.h"
+#include "artwork.h"
 
 #define MODULE_NAME "enna"
 
@@ -100,6 +102,29 @@ static Eina_List *od_files = NULL;
         valhalla_config_set(vh, SCANNER_SUFFIX, ext);          \
     }                                                          \
 
+/* Render the fixed size variants of freshly downloaded pictures once,
+ * so that the views never have to decode the originals. */
+static void
+_artwork_generate(Enna_File *file)
+{
+    const char *path;
+
+    path = enna_file_meta_get(file, "cover");
+    if (path)
+    {
+        enna_artwork_generate(path, ENNA_ARTWORK_ICON);
+        enna_artwork_generate(path, ENNA_ARTWORK_PANEL);
+        eina_stringshare_del(path);
+    }
+
+    path = enna_file_meta_get(file, "fanart");
+    if (path)
+    {
+        enna_artwork_generate(path, ENNA_ARTWORK_BACKDROP);
+        eina_stringshare_del(path);
+    }
+}
+
 static void
 pipe_read(void *data EINA_UNUSED, void *buf, unsigned int nbyte)
 {
@@ -116,8 +141,9 @@ pipe_read(void *data EINA_UNUSED, void *buf, unsigned int nbyte)
     {
         EINA_LIST_FOREACH(od_files, l, file)
         {
-            if (!strcmp(file->mrl+7, od->file))
+            if (!strcmp(enna_file_mrl_get(file)+7, od->file))
             {
+                _artwork_generate(file);
                 enna_file_meta_callback_call(file);
             }
         }
@@ -546,11 +572,15 @@ enna_metadata_meta_new(const char *file)
   if (!strncmp(file, "file://", 7))
       shift = 7;
 
+  ENNA_TRACE_BEGIN("metadata/meta_new");
   enna_log (ENNA_MSG_EVENT,
             MODULE_NAME, "Request for metadata on %s", file + shift);
   stmt = valhalla_db_file_get(vh, 0, file + shift, NULL);
   if (!stmt)
+  {
+      ENNA_TRACE_END("metadata/meta_new");
       return NULL;
+  }
 
   while ((metares = valhalla_db_file_read(vh, stmt)))
   {
@@ -571,6 +601,7 @@ enna_metadata_meta_new(const char *file)
         m = it = new;
   }
 
+  ENNA_TRACE_END("metadata/meta_new");
   return m;
 }
 
@@ -631,14 +662,14 @@ enna_metadata_meta_get(const Enna_Metadata *meta, const char *name, int max)
 void
 enna_metadata_meta_set(Enna_Metadata *meta, Enna_File *file, const char *name, const char *data)
 {
-    if (!meta || !file || !file->mrl || !name || !data)
+    if (!meta || !file || !enna_file_mrl_get(file) || !name || !data)
         return;
 
     for (; meta; meta = meta->next)
     {
         if (meta->meta && !strcmp(meta->meta, name))
         {
-            valhalla_db_metadata_update(vh, file->mrl + 7,
+            valhalla_db_metadata_update(vh, enna_file_mrl_get(file) + 7,
                                         name, meta->data, data,
                                         VALHALLA_LANG_UNDEF);
             return;
@@ -646,7 +677,7 @@ enna_metadata_meta_set(Enna_Metadata *meta, Enna_File *file, const char *name, c
     }
 
 
-    valhalla_db_metadata_insert(vh, file->mrl + 7,
+    valhalla_db_metadata_insert(vh, enna_file_mrl_get(file) + 7,
                                 name, data, VALHALLA_LANG_UNDEF,
                                 VALHALLA_META_GRP_MISCELLANEOUS);
 
@@ -672,21 +703,15 @@ enna_metadata_meta_get_all(const Enna_Metadata *meta)
   return str;
 }
 
-void
-enna_metadata_set_position(Enna_Metadata *meta EINA_UNUSED, double position EINA_UNUSED)
-{
-    /* to be implemented */
-}
-
 void
 enna_metadata_ondemand_add(Enna_File *file)
 {
     const char *uri;
 
-    if (!vh || !file || !file->mrl)
+    if (!vh || !file || !enna_file_mrl_get(file))
         return;
 
-    uri = file->mrl;
+    uri = enna_file_mrl_get(file);
     if (!strncmp(uri, "file://", 7))
         uri += 7;
 
@@ -701,15 +726,15 @@ enna_metadata_ondemand_del(Enna_File *file)
     Eina_List *l;
     Enna_File *f;
 
-    if (!vh || !file || !file->mrl)
+    if (!vh || !file || !enna_file_mrl_get(file))
         return;
 
     /* Add file to the list of on demand files */
     EINA_LIST_FOREACH(od_files, l, f)
     {
-        if (!f || !f->mrl)
+        if (!f || !enna_file_mrl_get(f))
             continue;
-        if (!strcmp(file->mrl, f->mrl))
+        if (!strcmp(enna_file_mrl_get(file), enna_file_mrl_get(f)))
             od_files = eina_list_remove(od_files, file);
     }
 }
@@ -47,7 +47,6 @@ void enna_metadata_meta_set(Enna_Metadata *meta,
                             const char *data);
 const char *enna_metadata_meta_get_all(const Enna_Metadata *meta);
 void  enna_metadata_meta_free(Enna_Metadata *meta);
-void enna_metadata_set_position(Enna_Metadata *meta, double position);
 void enna_metadata_ondemand_add(Enna_File *file);
 void enna_metadata_ondemand_del(Enna_File *file);
 char *enna_metadata_meta_duration_get(const Enna_Metadata *m);
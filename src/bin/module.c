@@ -19,7 +19,10 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include <string.h>
+
 #include <Eina.h>
+#include <Ecore.h>
 
 #include "enna.h"
 #include "module.h"
@@ -27,11 +30,37 @@
 #include "enna_config.h"
 #include "view_list2.h"
 #include "logs.h"
+#include "trace.h"
 
 #define ENABLE_CONFIG_PANEL 0
 
+/* how long the shutdown waits for the modules still initializing */
+#define MODULE_SHUTDOWN_WAIT 5.0
+
+/* Enna_Module state during the start-up */
+enum
+{
+    MODULE_STATE_NONE,
+    MODULE_STATE_PENDING,   /* waiting for its dependencies */
+    MODULE_STATE_THREAD,    /* init_thread running on a worker */
+    MODULE_STATE_PREPARED,  /* init_thread done, init not called yet */
+    MODULE_STATE_DONE,
+};
+
+typedef struct _Module_Job Module_Job;
+struct _Module_Job
+{
+    Enna_Module *m;
+    Ecore_Thread *thread;
+    double time;            /* spent on the worker, in seconds */
+    Eina_Bool orphan;       /* module released while the job was running */
+};
+
 static Eina_List *_enna_modules = NULL;   /** List of Enna_Modules* */
 static Eina_Array *_plugins_array = NULL; /** Array of Eina_Modules* (or api* in static mode)*/
+static Eina_List *_jobs = NULL;           /** Running Module_Job* */
+static Eina_Bool _shutting_down = EINA_FALSE;
+static double _startup_time = 0.0;
 
 #if ENABLE_CONFIG_PANEL
 static Enna_Config_Panel *_config_panel = NULL;
@@ -170,6 +199,40 @@ enna_module_init(void)
     return 0;
 }
 
+static Eina_Bool
+_module_jobs_wait_cb(void *data)
+{
+    Eina_Bool *expired = data;
+
+    *expired = EINA_TRUE;
+    return ECORE_CALLBACK_CANCEL;
+}
+
+/**
+ * @brief Wait (a bounded time) for the modules still initializing
+ *
+ * The code of a module must stay loaded as long as its init_thread runs.
+ * The main loop is iterated meanwhile, so this has to be called before
+ * anything is torn down.
+ */
+void
+enna_module_jobs_wait(void)
+{
+    Ecore_Timer *timer;
+    Eina_Bool expired = EINA_FALSE;
+
+    if (!_jobs)
+        return;
+
+    _shutting_down = EINA_TRUE;
+    timer = ecore_timer_add(MODULE_SHUTDOWN_WAIT, _module_jobs_wait_cb,
+                            &expired);
+    while (_jobs && !expired)
+        ecore_main_loop_iterate();
+    if (!expired)
+        ecore_timer_del(timer);
+}
+
 /**
  * @brief Disable/Free all modules registered and free the Eina_Module Array
  */
@@ -185,6 +248,22 @@ enna_module_shutdown(void)
     /* Disable and free all Enna_Modules */
     EINA_LIST_FREE(_enna_modules, m)
     {
+        if (m->state == MODULE_STATE_THREAD)
+        {
+            Module_Job *job;
+            Eina_List *l;
+
+            /* freed by the job once the worker returns */
+            EINA_LIST_FOREACH(_jobs, l, job)
+                if (job->m == m)
+                {
+                    job->orphan = EINA_TRUE;
+                    ecore_thread_cancel(job->thread);
+                }
+            enna_log(ENNA_MSG_WARNING, NULL,
+                     "Module %s still initializing", m->api->name);
+            continue;
+        }
         enna_log(ENNA_MSG_INFO, NULL, "Disable module : %s", m->api->name);
         if (m->enabled)
             enna_module_disable(m);
@@ -192,6 +271,14 @@ enna_module_shutdown(void)
     }
     _enna_modules = NULL;
 
+    if (_plugins_array && _jobs)
+    {
+        /* a worker may still run module code, keep it all mapped */
+        enna_log(ENNA_MSG_WARNING, NULL,
+                 "Modules still initializing, not unloaded");
+        _plugins_array = NULL;
+    }
+
     if (_plugins_array)
     {
 #ifdef USE_STATIC_MODULES
@@ -218,9 +305,12 @@ enna_module_enable(Enna_Module *m)
         return -1;
     if (m->enabled)
         return 0;
+    if (m->api->func.init_thread && m->state != MODULE_STATE_PREPARED)
+        m->api->func.init_thread(m);
     if (m->api->func.init)
         m->api->func.init(m);
     m->enabled = 1;
+    m->state = MODULE_STATE_DONE;
     return 0;
 }
 
@@ -243,8 +333,167 @@ enna_module_disable(Enna_Module *m)
     return -1;
 }
 
+static Enna_Module *
+_module_find(const char *name)
+{
+    Enna_Module *m;
+    Eina_List *l;
+
+    EINA_LIST_FOREACH(_enna_modules, l, m)
+        if (!strcmp(m->api->name, name))
+            return m;
+
+    return NULL;
+}
+
+static Eina_Bool
+_module_deps_done(Enna_Module *m)
+{
+    const char **dep;
+    Enna_Module *d;
+
+    if (!m->api->deps)
+        return EINA_TRUE;
+
+    /* modules which are not built are not waited for */
+    for (dep = m->api->deps; *dep; dep++)
+    {
+        d = _module_find(*dep);
+        if (d && d->state != MODULE_STATE_DONE)
+            return EINA_FALSE;
+    }
+
+    return EINA_TRUE;
+}
+
+static void
+_module_enable_timed(Enna_Module *m, double thread_time)
+{
+    double t0;
+
+    t0 = ecore_time_get();
+    ENNA_TRACE_BEGIN(m->api->name);
+    enna_module_enable(m);
+    ENNA_TRACE_END(m->api->name);
+
+    if (thread_time >= 0.0)
+        enna_log(ENNA_MSG_INFO, NULL,
+                 "Module %s initialized in %.1f ms (+%.1f ms on a worker)",
+                 m->api->name, (ecore_time_get() - t0) * 1000.0,
+                 thread_time * 1000.0);
+    else
+        enna_log(ENNA_MSG_INFO, NULL, "Module %s initialized in %.1f ms",
+                 m->api->name, (ecore_time_get() - t0) * 1000.0);
+}
+
+static void _modules_schedule(void);
+
+static void
+_module_job_run(void *data, Ecore_Thread *thread EINA_UNUSED)
+{
+    Module_Job *job = data;
+    double t0;
+
+    t0 = ecore_time_get();
+    ENNA_TRACE_BEGIN(job->m->api->name);
+    job->m->api->func.init_thread(job->m);
+    ENNA_TRACE_END(job->m->api->name);
+    job->time = ecore_time_get() - t0;
+}
+
+static void
+_module_job_end(void *data, Ecore_Thread *thread EINA_UNUSED)
+{
+    Module_Job *job = data;
+    Enna_Module *m = job->m;
+
+    _jobs = eina_list_remove(_jobs, job);
+    if (job->orphan)
+    {
+        free(m);
+        free(job);
+        return;
+    }
+
+    /* returned while quitting, freed with the other modules */
+    if (_shutting_down)
+    {
+        m->state = MODULE_STATE_PREPARED;
+        free(job);
+        return;
+    }
+
+    m->state = MODULE_STATE_PREPARED;
+    _module_enable_timed(m, job->time);
+    free(job);
+
+    _modules_schedule();
+}
+
+/* Initialize every pending module whose dependencies are done: the ones
+ * with an init_thread are started on a worker, the others are initialized
+ * right away. Called again each time a worker returns. */
+static void
+_modules_schedule(void)
+{
+    Enna_Module *m;
+    Eina_List *l;
+    Eina_Bool progress = EINA_TRUE;
+
+    while (progress)
+    {
+        progress = EINA_FALSE;
+        EINA_LIST_FOREACH(_enna_modules, l, m)
+        {
+            if (m->state != MODULE_STATE_PENDING || !_module_deps_done(m))
+                continue;
+
+            if (m->api->func.init_thread)
+            {
+                Module_Job *job;
+
+                job = ENNA_NEW(Module_Job, 1);
+                job->m = m;
+                m->state = MODULE_STATE_THREAD;
+                _jobs = eina_list_append(_jobs, job);
+                job->thread = ecore_thread_run(_module_job_run,
+                                               _module_job_end,
+                                               _module_job_end, job);
+            }
+            else
+            {
+                _module_enable_timed(m, -1.0);
+                progress = EINA_TRUE;
+            }
+        }
+    }
+
+    if (_jobs)
+        return;
+
+    /* nothing is running, what is still pending has circular dependencies */
+    EINA_LIST_FOREACH(_enna_modules, l, m)
+    {
+        if (m->state != MODULE_STATE_PENDING)
+            continue;
+        enna_log(ENNA_MSG_WARNING, NULL,
+                 "Module %s has unresolved dependencies", m->api->name);
+        _module_enable_timed(m, -1.0);
+    }
+
+    if (_startup_time > 0.0)
+    {
+        enna_log(ENNA_MSG_INFO, NULL, "Modules initialized in %.1f ms",
+                 (ecore_time_get() - _startup_time) * 1000.0);
+        _startup_time = 0.0;
+    }
+}
+
 /**
  * @brief Load/Enable all the know modules
+ *
+ * Modules are initialized in the order of their dependencies. The ones
+ * providing an init_thread may complete after this function returns.
  */
 void
 enna_module_load_all(void)
@@ -257,6 +506,8 @@ enna_module_load_all(void)
     if (!_plugins_array)
         return;
 
+    _startup_time = ecore_time_get();
+
 #ifdef USE_STATIC_MODULES
     EINA_ARRAY_ITER_NEXT(_plugins_array, i, api, iterator)
     {
@@ -271,8 +522,11 @@ enna_module_load_all(void)
 #endif /* USE_STATIC_MODULES */
 
         em = enna_module_open(api);
-        enna_module_enable(em);
+        if (em)
+            em->state = MODULE_STATE_PENDING;
     }
+
+    _modules_schedule();
 }
 
 /******************************************************************************/
@@ -345,8 +599,10 @@ _config_panel_show(void *data)
     }
 
     if (!_listener)
-        _listener = enna_input_listener_add("configuration/modules",
-                                            _input_events_cb, NULL);
+        _listener = enna_input_listener_add_full("configuration/modules",
+                                                 ENNA_INPUT_PRIORITY_NORMAL,
+                                                 ENNA_INPUT_MASK_NAVIGATION,
+                                                 _input_events_cb, NULL);
 
     return o_list;
 }
@@ -23,7 +23,7 @@
 #define MODULE_H
 
 
-#define ENNA_MODULE_VERSION 4
+#define ENNA_MODULE_VERSION 5
 
 #define MOD_PREFIX module /* default name for dynamic linking */
 #define MOD_APPEND_API(prefix)           prefix##_api
@@ -39,6 +39,7 @@ struct _Enna_Module
 {
     Enna_Module_Api *api;
     unsigned char enabled;
+    unsigned char state;    /* start-up scheduling, see module.c */
     void *mod;
 };
 
@@ -54,10 +55,17 @@ struct _Enna_Module_Api
     {
         void (*init)(Enna_Module *m);
         void (*shutdown)(Enna_Module *m);
+        /* Optional, non UI part of the initialization. At start-up it runs
+         * on a worker thread and init is called from the main loop once it
+         * is done, possibly after the main menu is shown. */
+        void (*init_thread)(Enna_Module *m);
     } func;
+    /* Optional, NULL terminated names of the modules to initialize first */
+    const char **deps;
 };
 
 int          enna_module_init(void);
+void         enna_module_jobs_wait(void);
 void         enna_module_shutdown(void);
 void         enna_module_load_all(void);
 int          enna_module_enable(Enna_Module *m);
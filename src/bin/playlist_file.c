@@ -0,0 +1,587 @@
+/*
+ * Enna Media Center
+ * Copyright (C) 2005-2013 Enna Team. All rights reserved.
+ *
+ * This file is part of Enna.
+ *
+ * Enna is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Enna is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Enna; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+
+#include <Eina.h>
+#include <Ecore.h>
+#include <Ecore_File.h>
+
+#include "enna.h"
+#include "logs.h"
+#include "utils.h"
+#include "vfs.h"
+#include "playlist_file.h"
+
+#define MODULE_NAME "playlist"
+
+/* entries handed to the main loop at once */
+#define LOADER_BATCH   256
+
+#define ENPL_MAGIC     "ENPL"
+#define ENPL_VERSION   1
+
+typedef enum
+{
+    PLAYLIST_FORMAT_M3U,
+    PLAYLIST_FORMAT_PLS,
+    PLAYLIST_FORMAT_ENPL,
+} Playlist_Format;
+
+typedef struct _Playlist_Entry Playlist_Entry;
+typedef struct _Playlist_Batch Playlist_Batch;
+
+struct _Playlist_Entry
+{
+    char *mrl;
+    char *label;
+    unsigned char type;         /* Enna_File_Type, 0 when unknown */
+};
+
+struct _Playlist_Batch
+{
+    int count;
+    Playlist_Entry entries[LOADER_BATCH];
+};
+
+struct _Enna_Playlist_Loader
+{
+    Ecore_Thread *thread;
+    char *filename;
+    char *dir;                  /* to resolve relative entries */
+    Playlist_Format format;
+    Playlist_Batch *batch;      /* being filled by the worker */
+    int count;
+    double start;
+    Eina_Bool cancelled;
+    void (*add)(void *data, Enna_File *file);
+    void (*done)(void *data, int count);
+    void *data;
+};
+
+static Playlist_Format
+_format_get(const char *filename)
+{
+    const char *ext;
+
+    ext = strrchr(filename, '.');
+    if (ext && !strcasecmp(ext, ".pls"))
+        return PLAYLIST_FORMAT_PLS;
+    if (ext && !strcasecmp(ext, ".enpl"))
+        return PLAYLIST_FORMAT_ENPL;
+    return PLAYLIST_FORMAT_M3U;
+}
+
+/*
+ * Worker side: libc, ecore_thread calls and enna_log (plain stdio writes)
+ * only, no Evas nor Enna_File in there.
+ */
+
+static void
+_batch_free(Playlist_Batch *b)
+{
+    int i;
+
+    for (i = 0; i < b->count; i++)
+    {
+        free(b->entries[i].mrl);
+        free(b->entries[i].label);
+    }
+    free(b);
+}
+
+/* Absolute mrl of a playlist entry: urls are kept, paths get file:// and
+ * are resolved against the playlist directory. */
+static char *
+_entry_mrl(Enna_Playlist_Loader *l, const char *path)
+{
+    char *mrl;
+    size_t len;
+
+    if (strstr(path, "://"))
+        return strdup(path);
+
+    len = strlen(path) + strlen(l->dir) + 9;
+    mrl = malloc(len);
+    if (!mrl)
+        return NULL;
+
+    if (path[0] == '/')
+        snprintf(mrl, len, "file://%s", path);
+    else
+        snprintf(mrl, len, "file://%s/%s", l->dir, path);
+    return mrl;
+}
+
+static void
+_entry_push(Enna_Playlist_Loader *l, Ecore_Thread *thread,
+            char *mrl, char *label, unsigned char type)
+{
+    Playlist_Entry *e;
+
+    if (!mrl)
+    {
+        free(label);
+        return;
+    }
+
+    if (!l->batch)
+    {
+        l->batch = calloc(1, sizeof(Playlist_Batch));
+        if (!l->batch)
+        {
+            free(mrl);
+            free(label);
+            return;
+        }
+    }
+
+    e = &l->batch->entries[l->batch->count++];
+    e->mrl = mrl;
+    e->label = label;
+    e->type = type;
+
+    if (l->batch->count == LOADER_BATCH)
+    {
+        ecore_thread_feedback(thread, l->batch);
+        l->batch = NULL;
+    }
+}
+
+static char *
+_line_strip(char *line)
+{
+    size_t len;
+
+    /* UTF-8 byte order mark, found at the top of some M3U8 */
+    if (!strncmp(line, "\xEF\xBB\xBF", 3))
+        line += 3;
+
+    len = strlen(line);
+    while (len && (line[len - 1] == '\n' || line[len - 1] == '\r' ||
+                   line[len - 1] == ' ' || line[len - 1] == '\t'))
+        line[--len] = '\0';
+    while (*line == ' ' || *line == '\t')
+        line++;
+
+    return line;
+}
+
+static void
+_read_m3u(Enna_Playlist_Loader *l, Ecore_Thread *thread, FILE *f)
+{
+    char *buf = NULL, *line, *title = NULL;
+    size_t size = 0;
+
+    while (getline(&buf, &size, f) > 0 && !ecore_thread_check(thread))
+    {
+        line = _line_strip(buf);
+        if (!*line)
+            continue;
+
+        if (*line == '#')
+        {
+            /* #EXTINF:<seconds>,<title> */
+            if (!strncmp(line, "#EXTINF:", 8))
+            {
+                char *comma = strchr(line + 8, ',');
+
+                free(title);
+                title = (comma && comma[1]) ? strdup(comma + 1) : NULL;
+            }
+            continue;
+        }
+
+        _entry_push(l, thread, _entry_mrl(l, line), title, 0);
+        title = NULL;
+    }
+
+    free(title);
+    free(buf);
+}
+
+static void
+_read_pls(Enna_Playlist_Loader *l, Ecore_Thread *thread, FILE *f)
+{
+    char *buf = NULL, *line, *value;
+    char *mrl = NULL, *title = NULL;
+    size_t size = 0;
+    int index = -1, n;
+
+    /* FileN and TitleN of an entry are grouped in practice, an entry is
+     * pushed as soon as a key of another one is read */
+    while (getline(&buf, &size, f) > 0 && !ecore_thread_check(thread))
+    {
+        line = _line_strip(buf);
+        value = strchr(line, '=');
+        if (!value)
+            continue;
+        *value++ = '\0';
+
+        if (!strncasecmp(line, "File", 4))
+            n = atoi(line + 4);
+        else if (!strncasecmp(line, "Title", 5))
+            n = atoi(line + 5);
+        else
+            continue;
+
+        if (n != index)
+        {
+            if (mrl)
+                _entry_push(l, thread, mrl, title, 0);
+            else
+                free(title);
+            mrl = title = NULL;
+            index = n;
+        }
+
+        if (!strncasecmp(line, "File", 4))
+        {
+            free(mrl);
+            mrl = _entry_mrl(l, value);
+        }
+        else
+        {
+            free(title);
+            title = *value ? strdup(value) : NULL;
+        }
+    }
+
+    if (mrl)
+        _entry_push(l, thread, mrl, title, 0);
+    else
+        free(title);
+    free(buf);
+}
+
+/* ENPL: magic, version, then for each entry its type, the lengths of the
+ * mrl and of the label (0 when there is none) and both strings. */
+static void
+_read_enpl(Enna_Playlist_Loader *l, Ecore_Thread *thread, FILE *f)
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t len[2];
+    unsigned char type;
+    char *mrl, *label;
+
+    if (fread(magic, 1, 4, f) != 4 || memcmp(magic, ENPL_MAGIC, 4) ||
+        fread(&version, sizeof(version), 1, f) != 1 ||
+        version != ENPL_VERSION)
+    {
+        enna_log(ENNA_MSG_ERROR, MODULE_NAME,
+                 "%s is not a valid playlist", l->filename);
+        return;
+    }
+
+    while (!ecore_thread_check(thread) &&
+           fread(&type, 1, 1, f) == 1 &&
+           fread(len, sizeof(uint32_t), 2, f) == 2)
+    {
+        if (!len[0] || len[0] > 65536 || len[1] > 65536)
+            break;
+
+        mrl = malloc(len[0] + 1);
+        label = len[1] ? malloc(len[1] + 1) : NULL;
+        if (!mrl || (len[1] && !label) ||
+            fread(mrl, 1, len[0], f) != len[0] ||
+            (label && fread(label, 1, len[1], f) != len[1]))
+        {
+            free(mrl);
+            free(label);
+            break;
+        }
+        mrl[len[0]] = '\0';
+        if (label)
+            label[len[1]] = '\0';
+
+        _entry_push(l, thread, mrl, label, type);
+    }
+}
+
+static void
+_loader_run(void *data, Ecore_Thread *thread)
+{
+    Enna_Playlist_Loader *l = data;
+    FILE *f;
+
+    f = fopen(l->filename, "rb");
+    if (!f)
+    {
+        enna_log(ENNA_MSG_ERROR, MODULE_NAME,
+                 "unable to open %s", l->filename);
+        return;
+    }
+
+    switch (l->format)
+    {
+    case PLAYLIST_FORMAT_PLS:
+        _read_pls(l, thread, f);
+        break;
+    case PLAYLIST_FORMAT_ENPL:
+        _read_enpl(l, thread, f);
+        break;
+    default:
+        _read_m3u(l, thread, f);
+        break;
+    }
+    fclose(f);
+
+    if (l->batch)
+    {
+        ecore_thread_feedback(thread, l->batch);
+        l->batch = NULL;
+    }
+}
+
+/*
+ * Main loop side
+ */
+
+static Enna_File *
+_entry_file_new(Playlist_Entry *e)
+{
+    Enna_File_Type type = e->type;
+    const char *name;
+
+    if (!type)
+        type = enna_util_uri_has_extension(e->mrl, ENNA_CAPS_VIDEO) ?
+            ENNA_FILE_FILM : ENNA_FILE_TRACK;
+
+    name = ecore_file_file_get(e->mrl);
+    if (!name || !*name)
+        name = e->mrl;
+
+    if (type == ENNA_FILE_FILM)
+        return enna_file_film_add(name, e->mrl, e->mrl,
+                                  e->label ? e->label : name, "icon/video");
+    return enna_file_track_add(name, e->mrl, e->mrl,
+                               e->label ? e->label : name, "icon/music");
+}
+
+static void
+_loader_notify(void *data, Ecore_Thread *thread EINA_UNUSED, void *msg)
+{
+    Enna_Playlist_Loader *l = data;
+    Playlist_Batch *b = msg;
+    Enna_File *file;
+    int i;
+
+    for (i = 0; i < b->count && !l->cancelled; i++)
+    {
+        file = _entry_file_new(&b->entries[i]);
+        l->add(l->data, file);
+        /* add() takes its own reference */
+        enna_file_free(file);
+        l->count++;
+    }
+    _batch_free(b);
+}
+
+static void
+_loader_free(Enna_Playlist_Loader *l)
+{
+    if (l->batch)
+        _batch_free(l->batch);
+    free(l->filename);
+    free(l->dir);
+    free(l);
+}
+
+static void
+_loader_end(void *data, Ecore_Thread *thread EINA_UNUSED)
+{
+    Enna_Playlist_Loader *l = data;
+
+    if (!l->cancelled)
+    {
+        enna_log(ENNA_MSG_INFO, MODULE_NAME,
+                 "%d entries loaded from %s in %.1f ms", l->count,
+                 l->filename, (ecore_time_get() - l->start) * 1000.0);
+        if (l->done)
+            l->done(l->data, l->count);
+    }
+    _loader_free(l);
+}
+
+Enna_Playlist_Loader *
+enna_playlist_file_load(const char *filename,
+                        void (*add)(void *data, Enna_File *file),
+                        void (*done)(void *data, int count),
+                        void *data)
+{
+    Enna_Playlist_Loader *l;
+
+    if (!filename || !add)
+        return NULL;
+
+    l = ENNA_NEW(Enna_Playlist_Loader, 1);
+    l->filename = strdup(filename);
+    l->dir = ecore_file_dir_get(filename);
+    if (!l->dir)
+        l->dir = strdup(".");
+    l->format = _format_get(filename);
+    l->start = ecore_time_get();
+    l->add = add;
+    l->done = done;
+    l->data = data;
+
+    l->thread = ecore_thread_feedback_run(_loader_run, _loader_notify,
+                                          _loader_end, _loader_end,
+                                          l, EINA_FALSE);
+    /* on failure the cancel callback has already released the loader */
+    if (!l->thread)
+        return NULL;
+
+    return l;
+}
+
+void
+enna_playlist_file_load_cancel(Enna_Playlist_Loader *loader)
+{
+    if (!loader)
+        return;
+
+    /* freed by _loader_end() once the worker has returned */
+    loader->cancelled = EINA_TRUE;
+    ecore_thread_cancel(loader->thread);
+}
+
+static const char *
+_file_path(Enna_File *file)
+{
+    const char *mrl = enna_file_mrl_get(file);
+
+    if (mrl && !strncmp(mrl, "file://", 7))
+        return mrl + 7;
+    return mrl;
+}
+
+static void
+_write_m3u(FILE *f, Enna_File **files, int count)
+{
+    int i;
+
+    fprintf(f, "#EXTM3U\n");
+    for (i = 0; i < count; i++)
+    {
+        const char *title;
+
+        if (!_file_path(files[i]))
+            continue;
+        title = files[i]->label ? files[i]->label : files[i]->name;
+        if (title)
+            fprintf(f, "#EXTINF:-1,%s\n", title);
+        fprintf(f, "%s\n", _file_path(files[i]));
+    }
+}
+
+static void
+_write_pls(FILE *f, Enna_File **files, int count)
+{
+    int i, n = 0;
+
+    fprintf(f, "[playlist]\n");
+    for (i = 0; i < count; i++)
+    {
+        if (!_file_path(files[i]))
+            continue;
+        n++;
+        fprintf(f, "File%d=%s\n", n, _file_path(files[i]));
+        if (files[i]->label)
+            fprintf(f, "Title%d=%s\n", n, files[i]->label);
+    }
+    fprintf(f, "NumberOfEntries=%d\nVersion=2\n", n);
+}
+
+static void
+_write_enpl(FILE *f, Enna_File **files, int count)
+{
+    uint32_t version = ENPL_VERSION;
+    uint32_t len[2];
+    unsigned char type;
+    const char *mrl;
+    int i;
+
+    fwrite(ENPL_MAGIC, 1, 4, f);
+    fwrite(&version, sizeof(version), 1, f);
+    for (i = 0; i < count; i++)
+    {
+        mrl = enna_file_mrl_get(files[i]);
+        if (!mrl)
+            continue;
+        type = files[i]->type;
+        len[0] = strlen(mrl);
+        len[1] = files[i]->label ? strlen(files[i]->label) : 0;
+        fwrite(&type, 1, 1, f);
+        fwrite(len, sizeof(uint32_t), 2, f);
+        fwrite(mrl, 1, len[0], f);
+        if (len[1])
+            fwrite(files[i]->label, 1, len[1], f);
+    }
+}
+
+int
+enna_playlist_file_save(const char *filename, Enna_File **files, int count)
+{
+    FILE *f;
+    int err;
+
+    if (!filename)
+        return -1;
+
+    f = fopen(filename, "wb");
+    if (!f)
+    {
+        enna_log(ENNA_MSG_ERROR, MODULE_NAME,
+                 "unable to open %s for writing", filename);
+        return -1;
+    }
+
+    switch (_format_get(filename))
+    {
+    case PLAYLIST_FORMAT_PLS:
+        _write_pls(f, files, count);
+        break;
+    case PLAYLIST_FORMAT_ENPL:
+        _write_enpl(f, files, count);
+        break;
+    default:
+        _write_m3u(f, files, count);
+        break;
+    }
+
+    err = ferror(f);
+    if (fclose(f) || err)
+    {
+        enna_log(ENNA_MSG_ERROR, MODULE_NAME,
+                 "error while writing %s", filename);
+        return -1;
+    }
+
+    enna_log(ENNA_MSG_INFO, MODULE_NAME, "%d entries saved to %s",
+             count, filename);
+    return 0;
+}
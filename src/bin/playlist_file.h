@@ -0,0 +1,45 @@
+/*
+ * GeeXboX Enna Media Center.
+ * Copyright (C) 2005-2010 The Enna Project
+ *
+ * This file is part of Enna.
+ *
+ * Enna is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Enna is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Enna; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+
+#ifndef PLAYLIST_FILE_H
+#define PLAYLIST_FILE_H
+
+#include "file.h"
+
+typedef struct _Enna_Playlist_Loader Enna_Playlist_Loader;
+
+/* Reads a M3U/M3U8, PLS or internal (.enpl) playlist on a worker thread.
+ * add is called from the main loop for each entry, in file order, then
+ * done with the number of entries once the whole file is read. The loader
+ * is freed after done, or by enna_playlist_file_load_cancel(). */
+Enna_Playlist_Loader *
+enna_playlist_file_load(const char *filename,
+                        void (*add)(void *data, Enna_File *file),
+                        void (*done)(void *data, int count),
+                        void *data);
+void enna_playlist_file_load_cancel(Enna_Playlist_Loader *loader);
+
+/* The format is chosen from the file extension, M3U by default */
+int enna_playlist_file_save(const char *filename,
+                            Enna_File **files, int count);
+
+#endif /* PLAYLIST_FILE_H */
@@ -0,0 +1,379 @@
+/*
+ * Enna Media Center
+ * Copyright (C) 2005-2013 Enna Team. All rights reserved.
+ *
+ * This file is part of Enna.
+ *
+ * Enna is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Enna is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Enna; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+
+/*
+ * Read-ahead of the file being played. The kernel read-ahead is sized for
+ * local disks, on NFS and SMB mounts a high bitrate stream drains it faster
+ * than it refills over a slow link. The range in front of the playback
+ * position is requested from a worker thread (readahead(2) blocks until
+ * the I/O is issued), as much as the configured seconds of playback of
+ * the volume the file lives on, converted with the average bitrate of the
+ * file.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <Eina.h>
+#include <Ecore.h>
+
+#include "enna.h"
+#include "enna_config.h"
+#include "logs.h"
+#include "volumes.h"
+#include "readahead.h"
+
+#define MODULE_NAME "readahead"
+
+/* seconds of playback read ahead, by kind of volume */
+#define READAHEAD_LOCAL_DEFAULT    0
+#define READAHEAD_NETWORK_DEFAULT  30
+#define READAHEAD_MAX_DEFAULT      64 /* MB */
+/* window used until the length of the stream is known */
+#define READAHEAD_DEPTH_MIN        (2 * 1024 * 1024)
+/* smaller requests are not worth a round trip to the worker */
+#define READAHEAD_CHUNK_MIN        (512 * 1024)
+
+typedef struct _Readahead Readahead;
+typedef struct _Readahead_Job Readahead_Job;
+
+struct _Readahead
+{
+    int fd;
+    off_t size;
+    int seconds;
+    off_t start;     /* playback offset the window was started from */
+    off_t issued;    /* end of the range requested so far */
+    Readahead_Job *job;
+    Eina_Bool dead : 1;
+};
+
+struct _Readahead_Job
+{
+    Readahead *ra;
+    int fd;
+    off_t offset;
+    size_t len;
+    double latency;
+    Eina_Bool late : 1; /* playback reached the range before its end */
+};
+
+typedef struct readahead_cfg_s {
+    Eina_Bool enabled;
+    int local;
+    int nfs;
+    int smb;
+    int max;
+} readahead_cfg_t;
+
+static readahead_cfg_t readahead_cfg;
+static Readahead *current = NULL;
+static Enna_Readahead_Stats stats;
+
+static void
+_readahead_free(Readahead *ra)
+{
+    close(ra->fd);
+    free(ra);
+}
+
+static void
+_readahead_job_cb(void *data, Ecore_Thread *thread EINA_UNUSED)
+{
+    Readahead_Job *job = data;
+    double t0;
+
+    t0 = ecore_time_get();
+#ifdef __linux__
+    if (readahead(job->fd, job->offset, job->len) < 0)
+#endif
+        posix_fadvise(job->fd, job->offset, job->len, POSIX_FADV_WILLNEED);
+    job->latency = ecore_time_get() - t0;
+}
+
+static void
+_readahead_job_end_cb(void *data, Ecore_Thread *thread EINA_UNUSED)
+{
+    Readahead_Job *job = data;
+    Readahead *ra = job->ra;
+
+    ra->job = NULL;
+    if (ra->dead)
+        _readahead_free(ra);
+    else
+    {
+        stats.chunks++;
+        stats.bytes += job->len;
+        if (job->latency > stats.latency_max)
+            stats.latency_max = job->latency;
+    }
+    free(job);
+}
+
+static void
+_readahead_issue(Readahead *ra, off_t end)
+{
+    Readahead_Job *job;
+
+    job = calloc(1, sizeof(Readahead_Job));
+    if (!job)
+        return;
+
+    job->ra = ra;
+    job->fd = ra->fd;
+    job->offset = ra->issued;
+    job->len = end - ra->issued;
+    ra->job = job;
+    ra->issued = end;
+
+    ecore_thread_run(_readahead_job_cb, _readahead_job_end_cb,
+                     _readahead_job_end_cb, job);
+}
+
+/* Depth configured for the volume holding path, the deepest mount point
+ * wins. */
+static int
+_volume_seconds_get(const char *path)
+{
+    Enna_Volume *v, *found = NULL;
+    Eina_List *l;
+    size_t len, found_len = 0;
+
+    EINA_LIST_FOREACH(enna_volumes_get(), l, v)
+    {
+        if (!v->mount_point)
+            continue;
+
+        len = strlen(v->mount_point);
+        if (len > found_len && !strncmp(path, v->mount_point, len) &&
+            (path[len] == '/' || path[len] == '\0'))
+        {
+            found = v;
+            found_len = len;
+        }
+    }
+
+    if (found && found->type == VOLUME_TYPE_NFS)
+        return readahead_cfg.nfs;
+    if (found && found->type == VOLUME_TYPE_SMB)
+        return readahead_cfg.smb;
+    return readahead_cfg.local;
+}
+
+void
+enna_readahead_start(const char *mrl)
+{
+    Readahead *ra;
+    struct stat st;
+    const char *path;
+    int fd;
+
+    enna_readahead_stop();
+    memset(&stats, 0, sizeof(stats));
+
+    if (!readahead_cfg.enabled || !mrl)
+        return;
+
+    if (!strncmp(mrl, "file://", 7))
+        path = mrl + 7;
+    else if (*mrl == '/')
+        path = mrl;
+    else
+        return;
+
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return;
+    if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode))
+    {
+        close(fd);
+        return;
+    }
+
+    /* let the kernel double its own window in any case */
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    ra = calloc(1, sizeof(Readahead));
+    if (!ra)
+    {
+        close(fd);
+        return;
+    }
+    ra->fd = fd;
+    ra->size = st.st_size;
+    ra->seconds = _volume_seconds_get(path);
+    current = ra;
+
+    enna_log(ENNA_MSG_EVENT, MODULE_NAME, "%s: %d s ahead", path,
+             ra->seconds);
+}
+
+void
+enna_readahead_update(double position, double length)
+{
+    Readahead *ra = current;
+    off_t offset, depth, end;
+
+    if (!ra || !ra->seconds || position < 0.0)
+        return;
+
+    depth = READAHEAD_DEPTH_MIN;
+    offset = ra->start;
+    if (length > 0.0)
+    {
+        off_t max = (off_t) readahead_cfg.max * 1024 * 1024;
+
+        depth = (off_t) (ra->size / length * ra->seconds);
+        if (depth < READAHEAD_DEPTH_MIN)
+            depth = READAHEAD_DEPTH_MIN;
+        if (depth > max)
+            depth = max;
+        offset = (off_t) (ra->size * (position / length));
+    }
+    stats.depth = depth;
+
+    if (offset < ra->start || offset > ra->issued + depth)
+    {
+        /* seek, start over from the new position */
+        stats.seeks++;
+        ra->start = ra->issued = offset;
+    }
+    else if (offset > ra->issued)
+    {
+        /* the player read past the window */
+        stats.underruns++;
+        ra->issued = offset;
+    }
+
+    if (ra->job)
+    {
+        if (!ra->job->late && offset > ra->job->offset)
+        {
+            ra->job->late = EINA_TRUE;
+            stats.underruns++;
+        }
+        return;
+    }
+
+    end = offset + depth;
+    if (end > ra->size)
+        end = ra->size;
+    if (end - ra->issued >= READAHEAD_CHUNK_MIN ||
+        (end == ra->size && end > ra->issued))
+        _readahead_issue(ra, end);
+}
+
+void
+enna_readahead_stop(void)
+{
+    Readahead *ra = current;
+
+    if (!ra)
+        return;
+
+    current = NULL;
+    if (ra->seconds)
+        enna_log(ENNA_MSG_EVENT, MODULE_NAME,
+                 "%u underruns, %u seeks, %u requests (%llu kB), "
+                 "slowest %.1f ms", stats.underruns, stats.seeks,
+                 stats.chunks, stats.bytes / 1024,
+                 stats.latency_max * 1000.0);
+
+    /* the worker still uses the descriptor */
+    if (ra->job)
+        ra->dead = EINA_TRUE;
+    else
+        _readahead_free(ra);
+}
+
+void
+enna_readahead_stats_get(Enna_Readahead_Stats *st)
+{
+    if (st)
+        *st = stats;
+}
+
+static void
+cfg_readahead_section_load(const char *section)
+{
+    int v;
+
+    if (enna_config_string_get(section, "enabled"))
+        readahead_cfg.enabled = enna_config_bool_get(section, "enabled");
+
+    /* 0 is meaningful here, the keys are only read when present */
+    if (enna_config_string_get(section, "local"))
+        readahead_cfg.local = enna_config_int_get(section, "local");
+    if (enna_config_string_get(section, "nfs"))
+        readahead_cfg.nfs = enna_config_int_get(section, "nfs");
+    if (enna_config_string_get(section, "smb"))
+        readahead_cfg.smb = enna_config_int_get(section, "smb");
+
+    v = enna_config_int_get(section, "max");
+    if (v > 0)
+        readahead_cfg.max = v;
+}
+
+static void
+cfg_readahead_section_save(const char *section)
+{
+    enna_config_bool_set(section, "enabled", readahead_cfg.enabled);
+    enna_config_int_set(section, "local", readahead_cfg.local);
+    enna_config_int_set(section, "nfs", readahead_cfg.nfs);
+    enna_config_int_set(section, "smb", readahead_cfg.smb);
+    enna_config_int_set(section, "max", readahead_cfg.max);
+}
+
+static void
+cfg_readahead_free(void)
+{
+}
+
+static void
+cfg_readahead_section_set_default(void)
+{
+    readahead_cfg.enabled = EINA_TRUE;
+    readahead_cfg.local   = READAHEAD_LOCAL_DEFAULT;
+    readahead_cfg.nfs     = READAHEAD_NETWORK_DEFAULT;
+    readahead_cfg.smb     = READAHEAD_NETWORK_DEFAULT;
+    readahead_cfg.max     = READAHEAD_MAX_DEFAULT;
+}
+
+static Enna_Config_Section_Parser cfg_readahead = {
+    "readahead",
+    cfg_readahead_section_load,
+    cfg_readahead_section_save,
+    cfg_readahead_section_set_default,
+    cfg_readahead_free,
+};
+
+void
+enna_readahead_cfg_register(void)
+{
+    enna_config_section_parser_register(&cfg_readahead);
+}
@@ -0,0 +1,51 @@
+/*
+ * GeeXboX Enna Media Center.
+ * Copyright (C) 2005-2010 The Enna Project
+ *
+ * This file is part of Enna.
+ *
+ * Enna is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Enna is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Enna; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+
+#ifndef READAHEAD_H
+#define READAHEAD_H
+
+#include "enna.h"
+
+typedef struct _Enna_Readahead_Stats Enna_Readahead_Stats;
+
+/* Counters of the file being played, reset by enna_readahead_start() */
+struct _Enna_Readahead_Stats
+{
+    unsigned int underruns;   /* playback caught up with the read-ahead */
+    unsigned int seeks;       /* window restarted away from the position */
+    unsigned int chunks;      /* read-ahead requests completed */
+    unsigned long long bytes; /* bytes requested ahead */
+    double latency_max;       /* slowest request, in seconds */
+    int depth;                /* current window, in bytes */
+};
+
+void enna_readahead_cfg_register(void);
+
+/* Start reading ahead of the playback of mrl (local paths and file://
+ * mrls only, anything else is ignored), any previous file is dropped. */
+void enna_readahead_start(const char *mrl);
+/* Playback position and length of the started file, in seconds */
+void enna_readahead_update(double position, double length);
+void enna_readahead_stop(void);
+void enna_readahead_stats_get(Enna_Readahead_Stats *stats);
+
+#endif /* READAHEAD_H */
@@ -0,0 +1,294 @@
+/*
+ * Enna Media Center
+ * Copyright (C) 2005-2013 Enna Team. All rights reserved.
+ *
+ * This file is part of Enna.
+ *
+ * Enna is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Enna is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Enna; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * The store is an append-only log of fixed size records, replayed into a
+ * hash at start-up, the last record of a key wins and a null position
+ * erases it. The log is rewritten from the hash once the stale records
+ * outnumber the live ones.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <Eina.h>
+
+#include "enna.h"
+#include "logs.h"
+#include "utils.h"
+#include "resume.h"
+
+#define MODULE_NAME "resume"
+
+#define RESUME_FILE        "resume.log"
+#define RESUME_MAGIC       "ENNARES1"
+#define RESUME_MAGIC_LEN   8
+/* positions closer than this to the stored one are not logged again */
+#define RESUME_MIN_DELTA   1.0
+/* stale records tolerated before a compaction */
+#define RESUME_COMPACT_MIN 256
+
+typedef struct _Resume_Record Resume_Record;
+
+struct _Resume_Record
+{
+    uint64_t key;
+    double position;
+};
+
+static Eina_Hash *positions = NULL;
+static FILE *log_file = NULL;
+static char *log_path = NULL;
+static unsigned int log_records = 0;
+
+static uint64_t
+_resume_key(const char *mrl)
+{
+    uint64_t h = ENNA_UTIL_HASH_INIT;
+    struct stat st;
+    uint64_t v;
+
+    if (!strncmp(mrl, "file://", 7) && !stat(mrl + 7, &st))
+    {
+        v = st.st_ino;
+        h = enna_util_hash(h, &v, sizeof(v));
+        v = st.st_size;
+        h = enna_util_hash(h, &v, sizeof(v));
+        v = st.st_mtime;
+        return enna_util_hash(h, &v, sizeof(v));
+    }
+
+    /* no identity for remote streams, fall back on the mrl */
+    return enna_util_hash(h, mrl, strlen(mrl));
+}
+
+static void
+_resume_apply(uint64_t key, double position)
+{
+    Resume_Record *r;
+
+    r = eina_hash_find(positions, &key);
+    if (position <= 0.0)
+    {
+        if (r)
+            eina_hash_del_by_key(positions, &key);
+        return;
+    }
+
+    if (!r)
+    {
+        r = calloc(1, sizeof(Resume_Record));
+        if (!r)
+            return;
+        r->key = key;
+        eina_hash_add(positions, &r->key, r);
+    }
+    r->position = position;
+}
+
+static FILE *
+_resume_log_open(const char *path, const char *mode)
+{
+    FILE *f;
+
+    f = fopen(path, mode);
+    if (!f)
+    {
+        enna_log(ENNA_MSG_ERROR, MODULE_NAME,
+                 "unable to open resume log %s", path);
+        return NULL;
+    }
+
+    fseek(f, 0, SEEK_END);
+    if (ftell(f) == 0)
+        fwrite(RESUME_MAGIC, 1, RESUME_MAGIC_LEN, f);
+    return f;
+}
+
+static void
+_resume_load(void)
+{
+    char magic[RESUME_MAGIC_LEN];
+    Resume_Record r;
+    FILE *f;
+
+    f = fopen(log_path, "rb");
+    if (!f)
+        return;
+
+    if (fread(magic, 1, RESUME_MAGIC_LEN, f) != RESUME_MAGIC_LEN ||
+        memcmp(magic, RESUME_MAGIC, RESUME_MAGIC_LEN))
+    {
+        enna_log(ENNA_MSG_WARNING, MODULE_NAME,
+                 "ignoring invalid resume log %s", log_path);
+        fclose(f);
+        return;
+    }
+
+    /* a truncated last record (crash while writing) is dropped */
+    while (fread(&r, sizeof(r), 1, f) == 1)
+    {
+        _resume_apply(r.key, r.position);
+        log_records++;
+    }
+
+    fclose(f);
+}
+
+static Eina_Bool
+_resume_compact_cb(const Eina_Hash *hash EINA_UNUSED, const void *key EINA_UNUSED,
+                   void *data, void *fdata)
+{
+    fwrite(data, sizeof(Resume_Record), 1, fdata);
+    return EINA_TRUE;
+}
+
+static void
+_resume_compact(void)
+{
+    char tmp[PATH_MAX];
+    FILE *f;
+
+    snprintf(tmp, sizeof(tmp), "%s.tmp", log_path);
+    f = _resume_log_open(tmp, "wb");
+    if (!f)
+        return;
+
+    eina_hash_foreach(positions, _resume_compact_cb, f);
+    if (fclose(f) || rename(tmp, log_path))
+    {
+        enna_log(ENNA_MSG_ERROR, MODULE_NAME,
+                 "unable to compact resume log %s", log_path);
+        unlink(tmp);
+        return;
+    }
+
+    log_records = eina_hash_population(positions);
+    enna_log(ENNA_MSG_INFO, MODULE_NAME,
+             "resume log compacted to %u records", log_records);
+
+    if (log_file)
+    {
+        fclose(log_file);
+        log_file = _resume_log_open(log_path, "ab");
+    }
+}
+
+static void
+_resume_compact_check(void)
+{
+    unsigned int live;
+
+    live = eina_hash_population(positions);
+    if (log_records > 2 * live + RESUME_COMPACT_MIN)
+        _resume_compact();
+}
+
+double
+enna_resume_position_get(const char *mrl)
+{
+    Resume_Record *r;
+    uint64_t key;
+
+    if (!positions || !mrl)
+        return 0.0;
+
+    key = _resume_key(mrl);
+    r = eina_hash_find(positions, &key);
+    return r ? r->position : 0.0;
+}
+
+void
+enna_resume_position_set(const char *mrl, double position)
+{
+    Resume_Record r, *old;
+
+    if (!positions || !mrl)
+        return;
+
+    if (position < 0.0)
+        position = 0.0;
+
+    r.key = _resume_key(mrl);
+    r.position = position;
+
+    old = eina_hash_find(positions, &r.key);
+    if (!old && position == 0.0)
+        return;
+    if (old && position != 0.0 &&
+        old->position - position < RESUME_MIN_DELTA &&
+        position - old->position < RESUME_MIN_DELTA)
+        return;
+
+    _resume_apply(r.key, r.position);
+
+    if (!log_file)
+        return;
+
+    fwrite(&r, sizeof(r), 1, log_file);
+    fflush(log_file);
+    log_records++;
+
+    _resume_compact_check();
+}
+
+int
+enna_resume_init(void)
+{
+    char path[PATH_MAX];
+
+    positions = eina_hash_int64_new(free);
+    if (!positions)
+        return -1;
+
+    snprintf(path, sizeof(path), "%s/%s",
+             enna_util_data_home_get(), RESUME_FILE);
+    log_path = strdup(path);
+
+    _resume_load();
+    enna_log(ENNA_MSG_INFO, MODULE_NAME, "%d resume points loaded",
+             eina_hash_population(positions));
+
+    _resume_compact_check();
+    log_file = _resume_log_open(log_path, "ab");
+
+    return 0;
+}
+
+void
+enna_resume_shutdown(void)
+{
+    if (log_file)
+        fclose(log_file);
+    log_file = NULL;
+
+    if (positions)
+        eina_hash_free(positions);
+    positions = NULL;
+
+    ENNA_FREE(log_path);
+    log_records = 0;
+}
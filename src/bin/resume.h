@@ -0,0 +1,37 @@
+/*
+ * GeeXboX Enna Media Center.
+ * Copyright (C) 2005-2010 The Enna Project
+ *
+ * This file is part of Enna.
+ *
+ * Enna is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Enna is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Enna; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef RESUME_H
+#define RESUME_H
+
+#include "enna.h"
+
+/* Resume points of partially played streams, keyed by file identity (inode,
+ * size and mtime) so that they survive renames but not re-encodes. */
+
+int enna_resume_init(void);
+void enna_resume_shutdown(void);
+
+double enna_resume_position_get(const char *mrl);
+/* a position of 0 forgets the resume point */
+void enna_resume_position_set(const char *mrl, double position);
+
+#endif /* RESUME_H */
@@ -62,12 +62,13 @@ _entry_focused_cb(void *data, Evas_Object *obj EINA_UNUSED, void *event_info EIN
 
     if (!sd)
         return;
-    /* Add an input lister when entry received focus, that blocks all Enna events */
-    sd->il = enna_input_listener_add("search/entry",
-                                     _entry_input_listener_cb, sd);
+    /* Add an input lister when entry received focus, that blocks all Enna events
+     * (letters are bound to player actions too, hence every class) */
+    sd->il = enna_input_listener_add_full("search/entry",
+                                          ENNA_INPUT_PRIORITY_HIGH,
+                                          ENNA_INPUT_MASK_ALL,
+                                          _entry_input_listener_cb, sd);
     elm_entry_entry_set(sd->o_edit, "");
-    /* Promote input lister to intercept ALL events */
-    enna_input_listener_promote(sd->il);
 
     evas_object_smart_callback_call(sd->o_layout, "focus", NULL);
     
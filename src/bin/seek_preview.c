@@ -0,0 +1,374 @@
+/*
+ * Enna Media Center
+ * Copyright (C) 2005-2013 Enna Team. All rights reserved.
+ *
+ * This file is part of Enna.
+ *
+ * Enna is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Enna is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Enna; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+
+/*
+ * Seeking in a film only to look for a scene is expensive: every position
+ * change makes the decoder flush and look for a keyframe. While the time
+ * slider is dragged, frames taken at regular intervals are shown instead
+ * and the only real seek happens on release.
+ *
+ * The frames are grabbed out of process by the ethumb daemon, one after
+ * the other, then composed once into a grid (the sprite sheet) stored in
+ * the data directory. The preview object shows one cell of the grid by
+ * moving the image fill, so dragging never decodes anything.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+
+#include <Eina.h>
+#include <Ecore.h>
+#include <Ecore_Evas.h>
+#include <Ecore_File.h>
+#include <Ethumb_Client.h>
+
+#include "enna.h"
+#include "logs.h"
+#include "utils.h"
+#include "seek_preview.h"
+
+#define MODULE_NAME "seek_preview"
+
+#define PATH_PREVIEWS     "previews"
+#define PREVIEW_QUALITY   "quality=80"
+#define PREVIEW_FRAMES    48
+#define PREVIEW_COLUMNS   8
+#define PREVIEW_ROWS      ((PREVIEW_FRAMES + PREVIEW_COLUMNS - 1) / PREVIEW_COLUMNS)
+#define PREVIEW_W         160
+#define PREVIEW_H         90
+
+struct _Enna_Seek_Preview
+{
+    Evas *evas;
+    Evas_Object *img;
+    Ethumb_Client *client;
+    const char *file;
+    char sheet[PATH_MAX];
+    char frames[PATH_MAX];
+    int frame;   /* next frame to grab */
+    int current; /* frame shown by img */
+    Eina_Bool ready;
+};
+
+static Eina_Bool
+_sheet_compose(Enna_Seek_Preview *sp)
+{
+    Ecore_Evas *ee;
+    Evas *evas;
+    Evas_Object *o;
+    char path[PATH_MAX];
+    int w = PREVIEW_COLUMNS * PREVIEW_W;
+    int h = PREVIEW_ROWS * PREVIEW_H;
+    int i;
+    Eina_Bool ret;
+
+    ee = ecore_evas_buffer_new(w, h);
+    if (!ee)
+        return EINA_FALSE;
+    evas = ecore_evas_get(ee);
+    evas_image_cache_set(evas, 0);
+
+    /* frames which could not be grabbed are left black */
+    o = evas_object_rectangle_add(evas);
+    evas_object_color_set(o, 0, 0, 0, 255);
+    evas_object_resize(o, w, h);
+    evas_object_show(o);
+
+    for (i = 0; i < PREVIEW_FRAMES; i++)
+    {
+        snprintf(path, sizeof(path), "%s/%03d.jpg", sp->frames, i);
+        o = evas_object_image_add(evas);
+        evas_object_image_file_set(o, path, NULL);
+        if (evas_object_image_load_error_get(o) != EVAS_LOAD_ERROR_NONE)
+        {
+            evas_object_del(o);
+            continue;
+        }
+        evas_object_image_smooth_scale_set(o, EINA_TRUE);
+        evas_object_image_fill_set(o, 0, 0, PREVIEW_W, PREVIEW_H);
+        evas_object_move(o, (i % PREVIEW_COLUMNS) * PREVIEW_W,
+                         (i / PREVIEW_COLUMNS) * PREVIEW_H);
+        evas_object_resize(o, PREVIEW_W, PREVIEW_H);
+        evas_object_show(o);
+    }
+
+    ret = enna_util_canvas_save(ee, sp->sheet, PREVIEW_QUALITY);
+    ecore_evas_free(ee);
+    return ret;
+}
+
+static void _frame_request(Enna_Seek_Preview *sp);
+
+static void
+_frame_generated_cb(void *data,
+                    Ethumb_Client *client EINA_UNUSED,
+                    int id EINA_UNUSED,
+                    const char *file EINA_UNUSED,
+                    const char *key EINA_UNUSED,
+                    const char *thumb_path EINA_UNUSED,
+                    const char *thumb_key EINA_UNUSED,
+                    Eina_Bool success)
+{
+    Enna_Seek_Preview *sp = data;
+
+    if (!success)
+        enna_log(ENNA_MSG_EVENT, MODULE_NAME,
+                 "no frame %d for %s", sp->frame, sp->file);
+
+    sp->frame++;
+    if (sp->frame < PREVIEW_FRAMES)
+    {
+        _frame_request(sp);
+        return;
+    }
+
+    if (_sheet_compose(sp))
+    {
+        enna_log(ENNA_MSG_EVENT, MODULE_NAME,
+                 "%s generated for %s", sp->sheet, sp->file);
+        sp->ready = EINA_TRUE;
+    }
+    else
+        enna_log(ENNA_MSG_WARNING, MODULE_NAME,
+                 "unable to compose the preview of %s", sp->file);
+    ecore_file_recursive_rm(sp->frames);
+}
+
+/* Frames are requested one at a time: the video time is part of the
+ * client setup, which is only sent along with the next request. */
+static void
+_frame_request(Enna_Seek_Preview *sp)
+{
+    char path[PATH_MAX];
+
+    snprintf(path, sizeof(path), "%s/%03d.jpg", sp->frames, sp->frame);
+    ethumb_client_video_time_set(sp->client,
+                                 (sp->frame + 0.5) / PREVIEW_FRAMES);
+    ethumb_client_thumb_path_set(sp->client, path, NULL);
+
+    if (ethumb_client_generate(sp->client, _frame_generated_cb, sp, NULL) < 0)
+        enna_log(ENNA_MSG_WARNING, MODULE_NAME,
+                 "unable to request the frames of %s", sp->file);
+}
+
+static void
+_server_die_cb(void *data, Ethumb_Client *client EINA_UNUSED)
+{
+    Enna_Seek_Preview *sp = data;
+
+    enna_log(ENNA_MSG_WARNING, MODULE_NAME,
+             "thumbnailer died while grabbing the frames of %s", sp->file);
+    ethumb_client_disconnect(sp->client);
+    ethumb_client_shutdown();
+    sp->client = NULL;
+}
+
+static void
+_connect_cb(void *data, Ethumb_Client *client, Eina_Bool success)
+{
+    Enna_Seek_Preview *sp = data;
+
+    if (!success)
+    {
+        enna_log(ENNA_MSG_WARNING, MODULE_NAME,
+                 "unable to connect to the thumbnailer");
+        /* the client is released by ethumb on failure */
+        ethumb_client_shutdown();
+        sp->client = NULL;
+        return;
+    }
+
+    ethumb_client_on_server_die_callback_set(client, _server_die_cb, sp, NULL);
+    ethumb_client_size_set(client, PREVIEW_W, PREVIEW_H);
+    ethumb_client_format_set(client, ETHUMB_THUMB_JPEG);
+    ethumb_client_aspect_set(client, ETHUMB_THUMB_CROP);
+    ethumb_client_crop_align_set(client, 0.5, 0.5);
+    if (!ethumb_client_file_set(client, sp->file, NULL))
+        return;
+
+    _frame_request(sp);
+}
+
+static void
+_fill_update(Enna_Seek_Preview *sp)
+{
+    int w, h;
+
+    /* one cell of the grid covers the whole object */
+    evas_object_geometry_get(sp->img, NULL, NULL, &w, &h);
+    evas_object_image_fill_set(sp->img,
+                               -(sp->current % PREVIEW_COLUMNS) * w,
+                               -(sp->current / PREVIEW_COLUMNS) * h,
+                               PREVIEW_COLUMNS * w, PREVIEW_ROWS * h);
+}
+
+static void
+_img_resize_cb(void *data,
+               Evas *e EINA_UNUSED,
+               Evas_Object *obj EINA_UNUSED,
+               void *event_info EINA_UNUSED)
+{
+    _fill_update(data);
+}
+
+static void
+_img_del_cb(void *data,
+            Evas *e EINA_UNUSED,
+            Evas_Object *obj EINA_UNUSED,
+            void *event_info EINA_UNUSED)
+{
+    Enna_Seek_Preview *sp = data;
+
+    sp->img = NULL;
+}
+
+Enna_Seek_Preview *
+enna_seek_preview_new(Evas *evas, const char *file)
+{
+    Enna_Seek_Preview *sp;
+    long long mtime;
+    uint64_t hash;
+
+    if (!evas || !file)
+        return NULL;
+
+    if (!strncmp(file, "file://", 7))
+        file += 7;
+
+    /* remote or missing file, grabbing frames would be far too slow */
+    mtime = ecore_file_mod_time(file);
+    if (!mtime)
+        return NULL;
+
+    sp = calloc(1, sizeof(Enna_Seek_Preview));
+    if (!sp)
+        return NULL;
+
+    sp->evas = evas;
+    sp->file = eina_stringshare_add(file);
+    sp->current = -1;
+
+    hash = enna_util_str_hash(file);
+    snprintf(sp->sheet, sizeof(sp->sheet), "%s/%s/%016llx.jpg",
+             enna_util_data_home_get(), PATH_PREVIEWS,
+             (unsigned long long) hash);
+    snprintf(sp->frames, sizeof(sp->frames), "%s/%s/%016llx",
+             enna_util_data_home_get(), PATH_PREVIEWS,
+             (unsigned long long) hash);
+
+    if (ecore_file_mod_time(sp->sheet) >= mtime)
+    {
+        sp->ready = EINA_TRUE;
+        return sp;
+    }
+
+    if (!ecore_file_is_dir(sp->frames) && !ecore_file_mkpath(sp->frames))
+    {
+        enna_log(ENNA_MSG_WARNING, MODULE_NAME,
+                 "unable to create %s", sp->frames);
+        return sp;
+    }
+
+    ethumb_client_init();
+    sp->client = ethumb_client_connect(_connect_cb, sp, NULL);
+    if (!sp->client)
+        ethumb_client_shutdown();
+
+    return sp;
+}
+
+void
+enna_seek_preview_free(Enna_Seek_Preview *sp)
+{
+    if (!sp)
+        return;
+
+    if (sp->client)
+    {
+        ethumb_client_disconnect(sp->client);
+        ethumb_client_shutdown();
+        /* interrupted, it starts over next time */
+        if (!sp->ready)
+            ecore_file_recursive_rm(sp->frames);
+    }
+
+    if (sp->img)
+    {
+        evas_object_event_callback_del(sp->img, EVAS_CALLBACK_DEL,
+                                       _img_del_cb);
+        evas_object_del(sp->img);
+    }
+
+    eina_stringshare_del(sp->file);
+    free(sp);
+}
+
+Eina_Bool
+enna_seek_preview_show(Enna_Seek_Preview *sp, double position)
+{
+    int frame;
+
+    if (!sp || !sp->ready)
+        return EINA_FALSE;
+
+    if (!sp->img)
+    {
+        sp->img = evas_object_image_add(sp->evas);
+        evas_object_image_file_set(sp->img, sp->sheet, NULL);
+        if (evas_object_image_load_error_get(sp->img) != EVAS_LOAD_ERROR_NONE)
+        {
+            evas_object_del(sp->img);
+            sp->img = NULL;
+            sp->ready = EINA_FALSE;
+            return EINA_FALSE;
+        }
+        evas_object_image_smooth_scale_set(sp->img, EINA_TRUE);
+        evas_object_event_callback_add(sp->img, EVAS_CALLBACK_RESIZE,
+                                       _img_resize_cb, sp);
+        evas_object_event_callback_add(sp->img, EVAS_CALLBACK_DEL,
+                                       _img_del_cb, sp);
+        sp->current = -1;
+    }
+
+    frame = (int) (position * PREVIEW_FRAMES);
+    if (frame < 0)
+        frame = 0;
+    else if (frame >= PREVIEW_FRAMES)
+        frame = PREVIEW_FRAMES - 1;
+
+    if (frame != sp->current)
+    {
+        sp->current = frame;
+        _fill_update(sp);
+    }
+
+    return EINA_TRUE;
+}
+
+Evas_Object *
+enna_seek_preview_object_get(Enna_Seek_Preview *sp)
+{
+    return sp ? sp->img : NULL;
+}
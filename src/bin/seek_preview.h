@@ -0,0 +1,41 @@
+/*
+ * GeeXboX Enna Media Center.
+ * Copyright (C) 2005-2010 The Enna Project
+ *
+ * This file is part of Enna.
+ *
+ * Enna is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Enna is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Enna; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+
+#ifndef SEEK_PREVIEW_H
+#define SEEK_PREVIEW_H
+
+#include <Evas.h>
+
+typedef struct _Enna_Seek_Preview Enna_Seek_Preview;
+
+/* Preview frames of a local film, shown while the time slider is dragged.
+ * The sprite sheet is generated in the background on first use and kept
+ * in the data directory, NULL is returned for non local files. */
+Enna_Seek_Preview *enna_seek_preview_new(Evas *evas, const char *file);
+void enna_seek_preview_free(Enna_Seek_Preview *sp);
+
+/* Show the frame closest to position (0.0 - 1.0) in the preview object,
+ * returns EINA_FALSE as long as the sprite sheet is not ready. */
+Eina_Bool enna_seek_preview_show(Enna_Seek_Preview *sp, double position);
+Evas_Object *enna_seek_preview_object_get(Enna_Seek_Preview *sp);
+
+#endif /* SEEK_PREVIEW_H */
@@ -24,6 +24,7 @@
 #include <Ecore_Ipc.h>
 
 #include "image.h"
+#include "trace.h"
 
 typedef struct _Enna_Thumb Enna_Thumb;
 
@@ -272,6 +273,7 @@ enna_thumb_client_data(Ecore_Ipc_Event_Client_Data *e)
     Enna_Thumb *eth;
     Evas_Object *obj;
 
+    ENNA_TRACE_BEGIN("thumb/client_data");
     if (!eina_list_data_find(_thumbnailers, e->client))
         _thumbnailers = eina_list_prepend(_thumbnailers, e->client);
     if (e->minor == 2)
@@ -311,6 +313,7 @@ enna_thumb_client_data(Ecore_Ipc_Event_Client_Data *e)
             _thumb_gen_begin(eth->objid, eth->file, eth->key, eth->w, eth->h);
         }
     }
+    ENNA_TRACE_END("thumb/client_data");
 }
 
 void
@@ -0,0 +1,345 @@
+/*
+ * Enna Media Center
+ * Copyright (C) 2005-2013 Enna Team. All rights reserved.
+ *
+ * This file is part of Enna.
+ *
+ * Enna is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Enna is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Enna; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include <Eina.h>
+#include <Ecore.h>
+
+#include "enna.h"
+#include "enna_config.h"
+#include "logs.h"
+#include "trace.h"
+
+#define MODULE_NAME "trace"
+
+#define TRACE_DEFAULT_RING_SIZE 16384
+#define TRACE_DEFAULT_FILE      "/tmp/enna-trace.json"
+
+typedef struct _Enna_Trace_Event Enna_Trace_Event;
+typedef struct _Enna_Trace_Ring Enna_Trace_Ring;
+
+struct _Enna_Trace_Event
+{
+    const char *name;
+    uint64_t ts; /* nanoseconds, CLOCK_MONOTONIC */
+    char phase;  /* 'B' or 'E' */
+};
+
+/* One ring per thread: only the owner thread writes into it, the oldest
+ * events are overwritten once the ring is full. */
+struct _Enna_Trace_Ring
+{
+    Enna_Trace_Event *events;
+    uint64_t head;
+    unsigned int tid;
+};
+
+typedef struct trace_cfg_s {
+    Eina_Bool enabled;
+    char *file;
+    int ring_size;
+} trace_cfg_t;
+
+Eina_Bool enna_trace_enabled = EINA_FALSE;
+
+static trace_cfg_t trace_cfg;
+static unsigned int ring_mask = 0;
+static Eina_List *rings = NULL;
+static Eina_Lock rings_lock;
+static unsigned int rings_count = 0;
+static Ecore_Event_Handler *usr_handler = NULL;
+static __thread Enna_Trace_Ring *thread_ring = NULL;
+
+static uint64_t
+_trace_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static Enna_Trace_Ring *
+_trace_ring_get(void)
+{
+    Enna_Trace_Ring *r;
+
+    if (thread_ring)
+        return thread_ring;
+
+    r = calloc(1, sizeof(Enna_Trace_Ring));
+    if (!r)
+        return NULL;
+
+    r->events = calloc(ring_mask + 1, sizeof(Enna_Trace_Event));
+    if (!r->events)
+    {
+        free(r);
+        return NULL;
+    }
+
+    eina_lock_take(&rings_lock);
+    r->tid = rings_count++;
+    rings = eina_list_append(rings, r);
+    eina_lock_release(&rings_lock);
+
+    thread_ring = r;
+    return r;
+}
+
+static void
+_trace_record(const char *name, char phase)
+{
+    Enna_Trace_Ring *r;
+    Enna_Trace_Event *ev;
+
+    r = _trace_ring_get();
+    if (!r)
+        return;
+
+    ev = &r->events[r->head & ring_mask];
+    ev->name  = name;
+    ev->ts    = _trace_now();
+    ev->phase = phase;
+    /* make the slot visible before publishing it to the dumper */
+    __atomic_store_n(&r->head, r->head + 1, __ATOMIC_RELEASE);
+}
+
+void
+enna_trace_begin(const char *name)
+{
+    _trace_record(name, 'B');
+}
+
+void
+enna_trace_end(const char *name)
+{
+    _trace_record(name, 'E');
+}
+
+static void
+_trace_json_string(FILE *f, const char *str)
+{
+    fputc('"', f);
+    for (; str && *str; str++)
+    {
+        if (*str == '"' || *str == '\\')
+            fputc('\\', f);
+        fputc(*str, f);
+    }
+    fputc('"', f);
+}
+
+/* Chrome trace event format, loadable in chrome://tracing */
+Eina_Bool
+enna_trace_dump(const char *filename)
+{
+    FILE *f;
+    Eina_List *l;
+    Enna_Trace_Ring *r;
+    Eina_Bool first = EINA_TRUE;
+    pid_t pid;
+
+    if (!rings)
+        return EINA_FALSE;
+
+    if (!filename)
+        filename = trace_cfg.file ? trace_cfg.file : TRACE_DEFAULT_FILE;
+
+    f = fopen(filename, "w");
+    if (!f)
+    {
+        enna_log(ENNA_MSG_ERROR, MODULE_NAME,
+                 "unable to open trace file %s", filename);
+        return EINA_FALSE;
+    }
+
+    pid = getpid();
+    fprintf(f, "{\"traceEvents\":[\n");
+
+    eina_lock_take(&rings_lock);
+    EINA_LIST_FOREACH(rings, l, r)
+    {
+        uint64_t head, i;
+
+        fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\","
+                "\"pid\":%d,\"tid\":%u,\"args\":{\"name\":\"%s%u\"}}",
+                first ? "" : ",\n", pid, r->tid,
+                r->tid ? "thread-" : "main-", r->tid);
+        first = EINA_FALSE;
+
+        /* the owner thread may go on recording while the ring is dumped:
+         * the slots are copied first, and a copy is dropped when the
+         * writer has wrapped onto its slot in the meantime */
+        head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+        i = head > ring_mask + 1 ? head - (ring_mask + 1) : 0;
+        for (; i < head; i++)
+        {
+            Enna_Trace_Event ev = r->events[i & ring_mask];
+
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&r->head, __ATOMIC_RELAXED) >= i + ring_mask + 1)
+                continue;
+
+            fprintf(f, ",\n{\"name\":");
+            _trace_json_string(f, ev.name);
+            fprintf(f, ",\"ph\":\"%c\",\"ts\":%llu.%03llu,"
+                    "\"pid\":%d,\"tid\":%u}",
+                    ev.phase,
+                    (unsigned long long) (ev.ts / 1000),
+                    (unsigned long long) (ev.ts % 1000),
+                    pid, r->tid);
+        }
+    }
+    eina_lock_release(&rings_lock);
+
+    fprintf(f, "\n]}\n");
+    fclose(f);
+
+    enna_log(ENNA_MSG_INFO, MODULE_NAME, "trace dumped to %s", filename);
+    return EINA_TRUE;
+}
+
+static Eina_Bool
+_trace_signal_user_cb(void *data EINA_UNUSED, int type EINA_UNUSED, void *event)
+{
+    Ecore_Event_Signal_User *ev = event;
+
+    if (ev->number == 1)
+        enna_trace_dump(NULL);
+
+    return ECORE_CALLBACK_PASS_ON;
+}
+
+static void
+cfg_trace_section_load(const char *section)
+{
+    const char *value;
+    int v;
+
+    trace_cfg.enabled = enna_config_bool_get(section, "enabled");
+
+    value = enna_config_string_get(section, "file");
+    if (value)
+    {
+        ENNA_FREE(trace_cfg.file);
+        trace_cfg.file = strdup(value);
+    }
+
+    v = enna_config_int_get(section, "ring_size");
+    if (v > 0)
+        trace_cfg.ring_size = v;
+}
+
+static void
+cfg_trace_section_save(const char *section)
+{
+    enna_config_bool_set(section, "enabled", trace_cfg.enabled);
+    enna_config_string_set(section, "file", trace_cfg.file);
+    enna_config_int_set(section, "ring_size", trace_cfg.ring_size);
+}
+
+static void
+cfg_trace_free(void)
+{
+    ENNA_FREE(trace_cfg.file);
+}
+
+static void
+cfg_trace_section_set_default(void)
+{
+    cfg_trace_free();
+
+    trace_cfg.enabled   = EINA_FALSE;
+    trace_cfg.file      = strdup(TRACE_DEFAULT_FILE);
+    trace_cfg.ring_size = TRACE_DEFAULT_RING_SIZE;
+}
+
+static Enna_Config_Section_Parser cfg_trace = {
+    "trace",
+    cfg_trace_section_load,
+    cfg_trace_section_save,
+    cfg_trace_section_set_default,
+    cfg_trace_free,
+};
+
+void
+enna_trace_cfg_register(void)
+{
+    enna_config_section_parser_register(&cfg_trace);
+}
+
+int
+enna_trace_init(void)
+{
+    unsigned int size = 1;
+
+    if (!trace_cfg.enabled)
+        return 0;
+
+    /* round up to a power of two so that the ring index is a mask */
+    while (size < (unsigned int) trace_cfg.ring_size)
+        size <<= 1;
+    ring_mask = size - 1;
+
+    eina_lock_new(&rings_lock);
+    usr_handler = ecore_event_handler_add(ECORE_EVENT_SIGNAL_USER,
+                                          _trace_signal_user_cb, NULL);
+
+    /* the first ring created belongs to the main loop */
+    _trace_ring_get();
+    enna_trace_enabled = EINA_TRUE;
+
+    enna_log(ENNA_MSG_INFO, MODULE_NAME,
+             "tracing enabled (%u events per thread), "
+             "send SIGUSR1 to dump into %s", size, trace_cfg.file);
+    return 1;
+}
+
+void
+enna_trace_shutdown(void)
+{
+    Enna_Trace_Ring *r;
+
+    if (!enna_trace_enabled)
+        return;
+
+    enna_trace_dump(NULL);
+    enna_trace_enabled = EINA_FALSE;
+
+    ENNA_EVENT_HANDLER_DEL(usr_handler);
+
+    eina_lock_take(&rings_lock);
+    EINA_LIST_FREE(rings, r)
+    {
+        free(r->events);
+        free(r);
+    }
+    eina_lock_release(&rings_lock);
+    eina_lock_free(&rings_lock);
+    thread_ring = NULL;
+}
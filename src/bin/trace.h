@@ -0,0 +1,53 @@
+/*
+ * GeeXboX Enna Media Center.
+ * Copyright (C) 2005-2010 The Enna Project
+ *
+ * This file is part of Enna.
+ *
+ * Enna is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Enna is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Enna; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "enna.h"
+
+/* Set when the [trace] section enables tracing, tested inline by the macros
+ * below so that instrumented code only pays a branch when tracing is off. */
+extern Eina_Bool enna_trace_enabled;
+
+void enna_trace_cfg_register(void);
+int enna_trace_init(void);
+void enna_trace_shutdown(void);
+
+void enna_trace_begin(const char *name);
+void enna_trace_end(const char *name);
+Eina_Bool enna_trace_dump(const char *filename);
+
+/* name must be a string literal (or any string outliving the process),
+ * only the pointer is recorded. */
+#define ENNA_TRACE_BEGIN(name)                          \
+    do {                                                \
+        if (EINA_UNLIKELY(enna_trace_enabled))          \
+            enna_trace_begin(name);                     \
+    } while (0)
+
+#define ENNA_TRACE_END(name)                            \
+    do {                                                \
+        if (EINA_UNLIKELY(enna_trace_enabled))          \
+            enna_trace_end(name);                       \
+    } while (0)
+
+#endif /* TRACE_H */
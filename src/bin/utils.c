@@ -20,15 +20,19 @@
  */
 
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
 #include <ctype.h>
 #include <math.h>
 #include <unistd.h>
 #include <stdio.h>
 #include <locale.h>
+#include <limits.h>
 
 #include <Eina.h>
 #include <Edje.h>
+#include <Ecore_Evas.h>
+#include <Ecore_File.h>
 
 #include "enna.h"
 
@@ -676,3 +680,61 @@ enna_util_stringlist_free(Eina_List *list)
     const char *s;
     EINA_LIST_FREE(list, s) eina_stringshare_del(s);
 }
+
+/* FNV-1a, chain the calls to hash several fields (start with
+ * ENNA_UTIL_HASH_INIT) */
+uint64_t
+enna_util_hash(uint64_t h, const void *data, size_t len)
+{
+    const unsigned char *p = data;
+
+    while (len--)
+    {
+        h ^= *p++;
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+uint64_t
+enna_util_str_hash(const char *str)
+{
+    return enna_util_hash(ENNA_UTIL_HASH_INIT, str, strlen(str));
+}
+
+/* Save what a buffer canvas rendered, through a temporary file renamed
+ * on success so that a truncated image is never left behind. The format
+ * comes from the extension of path. */
+Eina_Bool
+enna_util_canvas_save(Ecore_Evas *ee, const char *path, const char *flags)
+{
+    Evas_Object *out;
+    const void *pixels;
+    const char *ext;
+    char tmp[PATH_MAX];
+    int w, h;
+    Eina_Bool ret = EINA_FALSE;
+
+    pixels = ecore_evas_buffer_pixels_get(ee);
+    if (!pixels)
+        return EINA_FALSE;
+    ecore_evas_geometry_get(ee, NULL, NULL, &w, &h);
+
+    out = evas_object_image_add(ecore_evas_get(ee));
+    evas_object_image_size_set(out, w, h);
+    evas_object_image_alpha_set(out, EINA_FALSE);
+    evas_object_image_data_copy_set(out, (void *) pixels);
+
+    ext = strrchr(path, '.');
+    if (!ext || strchr(ext, '/'))
+        ext = "";
+    snprintf(tmp, sizeof(tmp), "%.*s.tmp%s",
+             (int) (strlen(path) - strlen(ext)), path, ext);
+    if (evas_object_image_save(out, tmp, NULL, flags) && !rename(tmp, path))
+        ret = EINA_TRUE;
+    else
+        ecore_file_unlink(tmp);
+
+    evas_object_del(out);
+    return ret;
+}
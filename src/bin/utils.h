@@ -22,7 +22,10 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include <stdint.h>
+
 #include <Evas.h>
+#include <Ecore_Evas.h>
 
 #define MMAX(a,b) ((a) > (b) ? (a) : (b))
 #define MMIN(a,b) ((a) > (b) ? (b) : (a))
@@ -65,4 +68,10 @@ const char *enna_util_duration_to_string(const char *length);
 Eina_List *enna_util_stringlist_get(const char *str);
 void enna_util_stringlist_free(Eina_List *list);
 
+#define ENNA_UTIL_HASH_INIT 0xcbf29ce484222325ULL
+uint64_t enna_util_hash(uint64_t h, const void *data, size_t len);
+uint64_t enna_util_str_hash(const char *str);
+
+Eina_Bool enna_util_canvas_save(Ecore_Evas *ee, const char *path, const char *flags);
+
 #endif /* UTILS_H */
@@ -34,6 +34,9 @@
 #include "mediaplayer_obj.h"
 #include "videoplayer_obj.h"
 #include "utils.h"
+#include "artwork.h"
+#include "readahead.h"
+#include "seek_preview.h"
 #include "logs.h"
 
 /* variable and macros used for the eina_log module */
@@ -102,6 +105,7 @@ int _enna_log_dom_global;
  *============================================================================*/
 
 #define OSD_TIMER    4.0
+#define OSD_TEXT_LEN 32
 
 typedef struct _Enna_View_Player_Video_Data Enna_View_Player_Video_Data;
 
@@ -113,7 +117,17 @@ struct _Enna_View_Player_Video_Data
     Evas_Object *cover;
 
     char *media;
+    Enna_Seek_Preview *preview;
+    Eina_Bool preview_shown;
     Eina_Bool on_hold;
+    double resume;
+
+    /* OSD refresh state, texts are only set when they change */
+    Eina_Bool osd_visible;
+    int osd_second;
+    char osd_current[OSD_TEXT_LEN];
+    char osd_duration[OSD_TEXT_LEN];
+    char osd_end_at[OSD_TEXT_LEN];
 };
 
 typedef struct mediaplayer_cfg_s {
@@ -206,23 +220,27 @@ _osd_timer_cb(void *data)
         return EINA_FALSE;
     }
     elm_object_signal_emit(priv->layout, "hide,osd", "enna");
+    /* nothing to refresh until the OSD is shown again */
+    priv->osd_visible = EINA_FALSE;
     return EINA_TRUE;
 }
 
 static void
-_set_osd_timer(Enna_View_Player_Video_Data *priv, double t)
+_osd_text_set(Enna_View_Player_Video_Data *priv, const char *part,
+              char *cache, const char *text)
 {
-    FREE_NULL_FUNC(ecore_timer_del, priv->osd_timer);
+    if (!strcmp(cache, text))
+        return;
 
-    if (t >= 0.0)
-        priv->osd_timer = ecore_timer_add(t, _osd_timer_cb, priv);
-    elm_object_signal_emit(priv->layout, "show,osd", "enna");
+    eina_strlcpy(cache, text, OSD_TEXT_LEN);
+    elm_object_part_text_set(priv->layout, part, text);
 }
 
 static void
-_update_time_part(Evas_Object *obj, const char *part, double t)
+_update_time_part(Enna_View_Player_Video_Data *priv, const char *part,
+                  char *cache, double t)
 {
-    Eina_Strbuf *str;
+    char buf[OSD_TEXT_LEN];
     double s;
     int h, m;
 
@@ -232,14 +250,75 @@ _update_time_part(Evas_Object *obj, const char *part, double t)
     m = (int)(s / 60.0);
     s -= m * 60;
 
-    str = eina_strbuf_new();
-    eina_strbuf_append_printf(str, "%02d:%02d:%02d", h, m, (int)s);
+    snprintf(buf, sizeof(buf), "%02d:%02d:%02d", h, m, (int)s);
+    _osd_text_set(priv, part, cache, buf);
+}
+
+static void
+_update_end_at_part(Enna_View_Player_Video_Data *priv, double remaining)
+{
+    char buf[OSD_TEXT_LEN];
+    time_t timestamp;
+    struct tm t;
+
+    timestamp = time(NULL) + remaining;
+    localtime_r(&timestamp, &t);
+    snprintf(buf, sizeof(buf), "End at %02dh%02d", t.tm_hour, t.tm_min);
+    _osd_text_set(priv, "time_end_at.text", priv->osd_end_at, buf);
+}
+
+static void
+_osd_update(Enna_View_Player_Video_Data *priv, double pos, double len)
+{
+    Evas_Object *edje;
+    double v;
+
+    _update_time_part(priv, "time_current.text", priv->osd_current, pos);
+    _update_time_part(priv, "time_duration.text", priv->osd_duration, len);
+    _update_end_at_part(priv, len - pos);
+
+    v = len > 0.0 ? pos / len : 0.0;
+    edje = elm_layout_edje_get(priv->layout);
+    edje_object_part_drag_value_set(edje, "time.slider", v, v);
+}
+
+static void
+_set_osd_timer(Enna_View_Player_Video_Data *priv, double t)
+{
+    Evas_Object *emotion;
+
+    FREE_NULL_FUNC(ecore_timer_del, priv->osd_timer);
+
+    if (t >= 0.0)
+        priv->osd_timer = ecore_timer_add(t, _osd_timer_cb, priv);
+    elm_object_signal_emit(priv->layout, "show,osd", "enna");
+
+    /* the OSD was frozen while hidden, bring it up to date */
+    if (!priv->osd_visible)
+    {
+        priv->osd_visible = EINA_TRUE;
+        priv->osd_second = -1;
+        emotion = elm_video_emotion_get(priv->video);
+        _osd_update(priv, emotion_object_position_get(emotion),
+                    emotion_object_play_length_get(emotion));
+    }
+}
+
+static void
+_preview_hide(Enna_View_Player_Video_Data *priv)
+{
+    Evas_Object *o;
 
-    elm_object_part_text_set(obj, part, eina_strbuf_string_get(str));
+    if (!priv->preview_shown)
+        return;
 
-    eina_strbuf_free(str);
+    o = elm_object_part_content_unset(priv->layout, "time.preview.swallow");
+    if (o)
+        evas_object_hide(o);
+    priv->preview_shown = EINA_FALSE;
 }
 
+/* Only the release seeks, the previews are shown while dragging */
 static void
 _slider_position_update_cb(void *data,
                            Evas_Object *obj EINA_UNUSED,
@@ -251,10 +330,8 @@ _slider_position_update_cb(void *data,
     Evas_Object *edje;
     double vx, vy;
     double pos;
-    time_t timestamp;
-    struct tm *t;
-    Eina_Strbuf *str;
 
+    _preview_hide(priv);
     emotion = elm_video_emotion_get(priv->video);
 
     edje = elm_layout_edje_get(priv->layout);
@@ -262,52 +339,35 @@ _slider_position_update_cb(void *data,
 
     pos = vx *  emotion_object_play_length_get(emotion);
 
-    _update_time_part(priv->layout, "time_current.text", pos);
-    _update_time_part(priv->layout, "time_duration.text", emotion_object_play_length_get(emotion));
-
-    timestamp = time(NULL);
-    timestamp += emotion_object_play_length_get(emotion) - pos;
-    t = localtime(&timestamp);
-    str = eina_strbuf_new();
-    eina_strbuf_append_printf(str, "End at %02dh%02d", t->tm_hour, t->tm_min);
-    elm_object_part_text_set(priv->layout, "time_end_at.text", eina_strbuf_string_get(str));
-    eina_strbuf_free(str);
+    _update_time_part(priv, "time_current.text", priv->osd_current, pos);
+    _update_time_part(priv, "time_duration.text", priv->osd_duration,
+                      emotion_object_play_length_get(emotion));
+    _update_end_at_part(priv, emotion_object_play_length_get(emotion) - pos);
+    priv->osd_second = -1;
 
     emotion_object_position_set(emotion, pos);
 }
 
-static void 
+/* Emotion ticks much more often than the displayed second changes: the OSD
+ * is refreshed at most once per second of stream, and not at all while it
+ * is hidden. */
+static void
 _emotion_position_update_cb(void *data, Evas_Object *obj EINA_UNUSED, void *event_info EINA_UNUSED)
 {
     Enna_View_Player_Video_Data *priv = data;
     Evas_Object *emotion;
-    Evas_Object *edje;
-    double v;
-    time_t timestamp;
-    struct tm *t;
-    Eina_Strbuf *str;
+    double pos, len;
 
     emotion = elm_video_emotion_get(priv->video);
+    pos = emotion_object_position_get(emotion);
+    len = emotion_object_play_length_get(emotion);
+    enna_readahead_update(pos, len);
 
-    _update_time_part(priv->layout, "time_current.text", 
-                      emotion_object_position_get(emotion));
-    _update_time_part(priv->layout, "time_duration.text", 
-                      emotion_object_play_length_get(emotion));
-
-    timestamp = time(NULL);
-    timestamp += emotion_object_play_length_get(emotion) -
-        emotion_object_position_get(emotion);
-    t = localtime(&timestamp);
-    str = eina_strbuf_new();
-    eina_strbuf_append_printf(str, "End at %02dh%02d", t->tm_hour, t->tm_min);
-    elm_object_part_text_set(priv->layout, "time_end_at.text", eina_strbuf_string_get(str));
-    eina_strbuf_free(str);
-
-    v = emotion_object_position_get(emotion) /
-        emotion_object_play_length_get(emotion);
+    if (!priv->osd_visible || (int) pos == priv->osd_second)
+        return;
 
-    edje = elm_layout_edje_get(priv->layout);
-    edje_object_part_drag_value_set(edje, "time.slider", v, v);
+    priv->osd_second = (int) pos;
+    _osd_update(priv, pos, len);
 }
 
 #if 0
@@ -377,6 +437,14 @@ _emotion_playback_started_cb(void *data, Evas_Object *obj EINA_UNUSED, void *eve
 {
     Enna_View_Player_Video_Data *priv = data;
 
+    /* the stream can only be seeked once it really plays */
+    if (priv->resume > 0.0)
+    {
+        emotion_object_position_set(elm_video_emotion_get(priv->video),
+                                    priv->resume);
+        priv->resume = 0.0;
+    }
+
     _set_osd_timer(priv, OSD_TIMER);
 }
 
@@ -395,9 +463,11 @@ _enna_view_del(void *data, Evas *e  EINA_UNUSED, Evas_Object *obj, void *event_i
 
     DBG("delete Enna_View_Player_Video_Data object (%p)", obj);
 
+    enna_readahead_stop();
     FREE_NULL_FUNC(evas_object_del, priv->video);
     FREE_NULL_FUNC(evas_object_del, priv->cover);
     FREE_NULL_FUNC(ecore_timer_del, priv->osd_timer);
+    FREE_NULL_FUNC(enna_seek_preview_free, priv->preview);
     FREE_NULL(priv->media);
 }
 
@@ -438,9 +508,6 @@ _drag_cb(void *data,
     Evas_Object *edje;
     double v;
     double pos;
-    time_t timestamp;
-    struct tm *t;
-    Eina_Strbuf *str;
 
     emotion = elm_video_emotion_get(priv->video);
 
@@ -449,9 +516,16 @@ _drag_cb(void *data,
 
     pos = v *  emotion_object_play_length_get(emotion);
 
-    _update_time_part(priv->layout, "time_current.text", pos);
-    _update_time_part(priv->layout, "time_duration.text", emotion_object_play_length_get(emotion));
+    _update_time_part(priv, "time_current.text", priv->osd_current, pos);
+    _update_time_part(priv, "time_duration.text", priv->osd_duration,
+                      emotion_object_play_length_get(emotion));
 
+    if (enna_seek_preview_show(priv->preview, v) && !priv->preview_shown)
+    {
+        elm_object_part_content_set(priv->layout, "time.preview.swallow",
+                                    enna_seek_preview_object_get(priv->preview));
+        priv->preview_shown = EINA_TRUE;
+    }
 }
 
 
@@ -477,6 +551,7 @@ enna_view_player_video_add(Evas_Object *parent)
     layout = elm_layout_add(parent);
     elm_layout_file_set(layout, enna_config_theme_get(), "activity/layout/player/video");
     priv->layout = layout;
+    priv->osd_second = -1;
 
     priv->video = elm_video_add(parent);
     elm_object_part_content_set(layout, "video.swallow", priv->video);
@@ -511,13 +586,19 @@ void enna_view_player_video_uri_set(Evas_Object *o, Enna_File *f)
     
     PRIV_GET_OR_RETURN(o, Enna_View_Player_Video_Data, priv);
 
-    priv->media = strdup(f->mrl);
+    priv->media = strdup(enna_file_mrl_get(f));
+
+    _preview_hide(priv);
+    FREE_NULL_FUNC(enna_seek_preview_free, priv->preview);
+    priv->preview = enna_seek_preview_new(evas_object_evas_get(priv->layout),
+                                          enna_file_mrl_get(f));
 
-    DBG("Start video player with item: %s", f->mrl);
+    DBG("Start video player with item: %s", enna_file_mrl_get(f));
 
-    if (!strncmp(f->mrl, "file://", 7))
+    if (!strncmp(enna_file_mrl_get(f), "file://", 7))
         prefix = 7;
-    elm_video_file_set(priv->video, f->mrl + prefix);
+    elm_video_file_set(priv->video, enna_file_mrl_get(f) + prefix);
+    enna_readahead_start(enna_file_mrl_get(f));
 
     title = enna_file_meta_get(f, "title");
     if (title)
@@ -527,17 +608,19 @@ void enna_view_player_video_uri_set(Evas_Object *o, Enna_File *f)
     }   
     else
     {
-        title = ecore_file_file_get(f->mrl);
+        title = ecore_file_file_get(enna_file_mrl_get(f));
         elm_object_part_text_set(priv->layout, "title.text", title);
     }
 
     cover = enna_file_meta_get(f, "cover");
     if (cover)
     {
+        const char *art = enna_artwork_get(cover, ENNA_ARTWORK_ICON);
+
         priv->cover = elm_icon_add(priv->layout);
-        printf("cover : %s\n", enna_file_meta_get(f, "cover"));
-       
-        elm_image_file_set(priv->cover, cover,  NULL);
+        elm_image_file_set(priv->cover, art, NULL);
+        eina_stringshare_del(art);
+        eina_stringshare_del(cover);
         elm_image_preload_disabled_set(priv->cover, EINA_FALSE);
        
         elm_object_part_content_set(priv->layout, "cover.swallow", priv->cover);
@@ -574,6 +657,7 @@ void enna_view_player_video_stop(Evas_Object *o)
     PRIV_GET_OR_RETURN(o, Enna_View_Player_Video_Data, priv);
 
     elm_video_stop(priv->video);
+    enna_readahead_stop();
 }
 
 void enna_videoplayer_obj_cfg_register(void)
@@ -597,8 +681,6 @@ void enna_view_video_player_seek(Evas_Object *o, double t)
     Evas_Object *edje;
     double v;
     double pos;
-    time_t timestamp;
-    Eina_Strbuf *str;
 
     PRIV_GET_OR_RETURN(o, Enna_View_Player_Video_Data, priv);
 
@@ -609,8 +691,10 @@ void enna_view_video_player_seek(Evas_Object *o, double t)
 
     pos = v *  emotion_object_play_length_get(emotion) + t;
 
-    _update_time_part(priv->layout, "time_current.text", pos);
-    _update_time_part(priv->layout, "time_duration.text", emotion_object_play_length_get(emotion));
+    _update_time_part(priv, "time_current.text", priv->osd_current, pos);
+    _update_time_part(priv, "time_duration.text", priv->osd_duration,
+                      emotion_object_play_length_get(emotion));
+    priv->osd_second = -1;
 
     v = pos / emotion_object_play_length_get(emotion);
 
@@ -620,3 +704,27 @@ void enna_view_video_player_seek(Evas_Object *o, double t)
     emotion_object_position_set(emotion, pos);
 
 }
+
+double enna_view_player_video_position_get(Evas_Object *o)
+{
+    PRIV_DATA_GET(o, Enna_View_Player_Video_Data, priv);
+
+    if (!priv)
+        return 0.0;
+
+    return emotion_object_position_get(elm_video_emotion_get(priv->video));
+}
+
+void enna_view_player_video_resume_set(Evas_Object *o, double position)
+{
+    PRIV_GET_OR_RETURN(o, Enna_View_Player_Video_Data, priv);
+
+    priv->resume = position;
+}
+
+Evas_Object *enna_view_player_video_emotion_get(Evas_Object *o)
+{
+    PRIV_DATA_GET(o, Enna_View_Player_Video_Data, priv);
+
+    return priv ? elm_video_emotion_get(priv->video) : NULL;
+}
@@ -31,5 +31,8 @@ void enna_videoplayer_obj_cfg_register(void);
 void enna_view_player_video_play(Evas_Object *o);
 void enna_view_video_player_show_osd(Evas_Object *o, Eina_Bool show);
 void enna_view_video_player_seek(Evas_Object *o, double t);
+double enna_view_player_video_position_get(Evas_Object *o);
+void enna_view_player_video_resume_set(Evas_Object *o, double position);
+Evas_Object *enna_view_player_video_emotion_get(Evas_Object *o);
 
 #endif
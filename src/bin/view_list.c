@@ -304,7 +304,7 @@ _list_item_track_icon_get(void *data, Evas_Object *obj, const char *part)
         if (!tmp)
             return NULL;
 
-        else if (strcmp(li->file->mrl, tmp))
+        else if (strcmp(enna_file_mrl_get(li->file), tmp))
         {
             eina_stringshare_del(tmp);
             return NULL;
@@ -551,7 +551,8 @@ enna_list_file_append(Evas_Object *obj, Enna_File *file,
     /* Select first item */
     if (!sd->selected && (eina_list_count(sd->items) == 1))
         enna_list_select_nth(obj, 0);
-    else if (file && sd->selected && !strcmp(file->uri, sd->selected->uri))
+    else if (file && sd->selected &&
+             !strcmp(enna_file_uri_get(file), enna_file_uri_get(sd->selected)))
         enna_list_select_file(obj, sd->selected);
        
 
@@ -615,7 +616,8 @@ enna_list_select_file(Evas_Object *obj, Enna_File *file)
 
      EINA_LIST_FOREACH(sd->items, l, it)
      {
-         if (it && it->file && !strcmp(it->file->uri, file->uri))
+         if (it && it->file &&
+             !strcmp(enna_file_uri_get(it->file), enna_file_uri_get(file)))
              break;
          nth++;
      }
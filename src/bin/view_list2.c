@@ -476,9 +476,12 @@ _list_item_button_event_input_focus_set(Enna_View_List2_Widget *ib, Eina_Bool fo
     {
         if (focus)
         {
-            ib->input_listener = enna_input_listener_add("view_list2/entry",
-                                                          _list_item_button_input_events_cb, ib);
-            enna_input_listener_promote(ib->input_listener);
+            /* swallows everything typed, whatever the class */
+            ib->input_listener =
+                enna_input_listener_add_full("view_list2/entry",
+                                             ENNA_INPUT_PRIORITY_HIGH,
+                                             ENNA_INPUT_MASK_ALL,
+                                             _list_item_button_input_events_cb, ib);
             //elm_object_focus(ib->obj);
             //evas_object_focus_set(ib->obj, EINA_TRUE);
         }
@@ -101,9 +101,9 @@ _grid_item_icon_get(void *data, Evas_Object *obj, const char *part)
 		else
 		{
                     ic = elm_thumb_add(obj);
-                    printf("file set : %s\n", pi->file->mrl + 7);
+                    printf("file set : %s\n", enna_file_mrl_get(pi->file) + 7);
 
-                    elm_thumb_file_set(ic, pi->file->mrl + 7, NULL);
+                    elm_thumb_file_set(ic, enna_file_mrl_get(pi->file) + 7, NULL);
                     evas_object_show(ic);
 
                     return ic;
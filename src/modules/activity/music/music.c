@@ -85,26 +85,15 @@ struct _Enna_Module_Music
 static Enna_Module_Music *mod;
 
 static void
-update_songs_counter(Eina_List *list)
+update_songs_counter(int children)
 {
-    Enna_File *f;
-    Eina_List *l;
-    int children = 0;
     char label[128] = { 0 };
     Evas_Object *o_edje;
 
     DBG(__FUNCTION__);
-    if (!list)
-        goto end;
-
-    EINA_LIST_FOREACH(list, l, f)
-    {
-        if (f->type != ENNA_FILE_DIRECTORY)
-            children++;
-    }
     if (children)
         snprintf(label, sizeof(label), _("%d Songs"), children);
-end:
+
     o_edje = elm_layout_edje_get(mod->o_layout);
     edje_object_part_text_set(o_edje, "songs.counter.label", label);
 }
@@ -114,7 +103,7 @@ _class_event_browser_view(enna_input event)
 {
     DBG(__FUNCTION__);
     if (event == ENNA_INPUT_BACK)
-        update_songs_counter(NULL);
+        update_songs_counter(0);
 
     switch (event)
     {
@@ -193,9 +182,7 @@ _browser_root_cb(void *data EINA_UNUSED, Evas_Object *obj EINA_UNUSED, void *eve
 static void
 _browser_selected_cb(void *data EINA_UNUSED, Evas_Object *obj EINA_UNUSED, void *event_info)
 {
-    int i = 0;
     Enna_File *file = event_info;
-    Eina_List *files = enna_browser_obj_files_get(mod->o_browser);
 
     DBG(__FUNCTION__);
     if (!file)
@@ -204,33 +191,30 @@ _browser_selected_cb(void *data EINA_UNUSED, Evas_Object *obj EINA_UNUSED, void
     if (ENNA_FILE_IS_BROWSABLE(file))
     {
         enna_log(ENNA_MSG_EVENT,
-                 ENNA_MODULE_NAME, "Directory Selected %s", file->uri);
-        update_songs_counter(files);
+                 ENNA_MODULE_NAME, "Directory Selected %s", enna_file_uri_get(file));
+        update_songs_counter(enna_browser_obj_count_get(mod->o_browser,
+                                            ENNA_BROWSER_COUNT_FILES));
     }
     else
     {
-        Enna_File *f;
-        Eina_List *l;
-        DBG("File Selected %s", file->uri);
+        Enna_File_Array *media;
+        int i;
+
+        DBG("File Selected %s", enna_file_uri_get(file));
         enna_mediaplayer_playlist_stop_clear(mod->enna_playlist);
-        /* File selected, create mediaplayer */
-         EINA_LIST_FOREACH(files, l, f)
-         {
-             if (f->type != ENNA_FILE_DIRECTORY)
-             {
-                 enna_mediaplayer_file_append(mod->enna_playlist, f);
-                 if (!strcmp(f->uri, file->uri))
-                 {
-                     enna_mediaplayer_select_nth(mod->enna_playlist,i);
-                     enna_mediaplayer_obj_event_catch(mod->o_mediaplayer);
-                     enna_mediaplayer_play(mod->enna_playlist);
-
-                 }
-                 i++;
-             }
-         }
-         
-         _panel_infos_display(0);
+        /* File selected, play the listing from it, the playlist references
+         * the files of the browser */
+        media = enna_browser_obj_media_get(mod->o_browser);
+        enna_mediaplayer_playlist_view_set(mod->enna_playlist, media);
+        i = enna_file_array_index_get(media, file);
+        if (i >= 0)
+        {
+            enna_mediaplayer_select_nth(mod->enna_playlist, i);
+            enna_mediaplayer_obj_event_catch(mod->o_mediaplayer);
+            enna_mediaplayer_play(mod->enna_playlist);
+        }
+
+        _panel_infos_display(0);
     }
 }
 
@@ -250,9 +234,9 @@ _browser_delay_hilight_cb(void *data EINA_UNUSED, Evas_Object *obj EINA_UNUSED,
 #if 0
 
     if (!ENNA_FILE_IS_BROWSABLE(file) &&
-        file->mrl)
+        enna_file_mrl_get(file))
         /* ask for on-demand scan for local files */
-        if (!strncmp(file->mrl, "file://", 7))
+        if (!strncmp(enna_file_mrl_get(file), "file://", 7))
             enna_metadata_ondemand(file, _ondemand_cb_refresh);
 #endif
 }
@@ -1,4 +1,5 @@
 SRCS_ACTIVITY_PHOTO = \
 	$(top_srcdir)/src/modules/activity/photo/photo.c \
 	$(top_srcdir)/src/modules/activity/photo/photo_infos.c \
+	$(top_srcdir)/src/modules/activity/photo/photo_exif.c \
 	$(top_srcdir)/src/modules/activity/photo/photo_slideshow_view.c
@@ -115,8 +115,10 @@ static void _create_slideshow_gui(void)
 }
 
 
+/* Only the files are handed over, their mrl is built when the slideshow
+ * registers them */
 static int
-_slideshow_add_files(const char *file_selected)
+_slideshow_add_files(Enna_File *file_selected)
 {
     Eina_List *files = NULL;
     Eina_List *l;
@@ -130,12 +132,12 @@ _slideshow_add_files(const char *file_selected)
     files = enna_browser_obj_files_get (mod->o_browser);
     EINA_LIST_FOREACH(files, l, file)
     {
-        if (!file->mrl)
+        if (ENNA_FILE_IS_BROWSABLE(file))
             continue;
-        if (!strcmp(file_selected, file->mrl))
+        if (file == file_selected)
             pos = n;
 
-        enna_photo_slideshow_image_add(mod->o_slideshow, file->mrl + 7, NULL);
+        enna_photo_slideshow_file_add(mod->o_slideshow, file);
         n++;
     }
 
@@ -160,7 +162,7 @@ _browser_cb_selected (void *data EINA_UNUSED, Evas_Object *obj EINA_UNUSED, void
     {
         /* File is selected, display it in slideshow mode */
         _create_slideshow_gui();
-        pos = _slideshow_add_files(file->mrl);
+        pos = _slideshow_add_files(file);
         enna_photo_slideshow_goto(mod->o_slideshow, pos);
     }
 }
@@ -171,16 +173,16 @@ _browser_cb_hilight (void *data EINA_UNUSED, Evas_Object *obj EINA_UNUSED, void
     Enna_File *file = event_info;
     Evas_Object *o_edje;
 
-    if (!file || !file->mrl)
+    if (!file || !enna_file_mrl_get(file))
         return;
 
     o_edje = elm_layout_edje_get(mod->o_layout);
     edje_object_part_text_set(o_edje, "filename.text", file->label);
 
     if (file->type != ENNA_FILE_DIRECTORY || file->type != ENNA_FILE_MENU)
-        photo_panel_infos_set_cover(mod->o_infos, file->mrl + 7);
+        photo_panel_infos_set_cover(mod->o_infos, enna_file_mrl_get(file) + 7);
 
-    photo_panel_infos_set_text(mod->o_infos, file->mrl + 7);
+    photo_panel_infos_set_text(mod->o_infos, enna_file_mrl_get(file) + 7);
 }
 
 static void
@@ -359,6 +361,7 @@ module_init(Enna_Module *em)
     mod->em = em;
     em->mod = mod;
 
+    enna_photo_slideshow_cfg_register();
     enna_activity_register(&class);
 }
 
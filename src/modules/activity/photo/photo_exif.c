@@ -0,0 +1,480 @@
+/*
+ * Enna Media Center
+ * Copyright (C) 2005-2013 Enna Team. All rights reserved.
+ *
+ * This file is part of Enna.
+ *
+ * Enna is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Enna is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Enna; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Minimal JPEG header parser: only the markers in front of the image data
+ * are mapped, the APP1 segment gives the EXIF fields (TIFF IFD0 and EXIF
+ * sub-IFD) and the APP13 one the IPTC record.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "enna.h"
+#include "buffer.h"
+#include "photo_exif.h"
+
+/* APP segments are at most 64 kB, the headers seldom take more than two */
+#define EXIF_MAP_SIZE (128 * 1024)
+
+#define JPEG_SOI   0xD8
+#define JPEG_EOI   0xD9
+#define JPEG_SOS   0xDA
+#define JPEG_APP1  0xE1
+#define JPEG_APP13 0xED
+
+#define TAG_MAKE          0x010F
+#define TAG_MODEL         0x0110
+#define TAG_DATETIME      0x0132
+#define TAG_EXIF_IFD      0x8769
+#define TAG_EXPOSURE_TIME 0x829A
+#define TAG_FNUMBER       0x829D
+#define TAG_ISO           0x8827
+#define TAG_DATETIME_ORIG 0x9003
+#define TAG_FLASH         0x9209
+#define TAG_FOCAL_LENGTH  0x920A
+#define TAG_PIXEL_X       0xA002
+#define TAG_PIXEL_Y       0xA003
+
+#define IPTC_OBJECT_NAME  5
+#define IPTC_KEYWORDS     25
+#define IPTC_BYLINE       80
+#define IPTC_CAPTION      120
+
+#define FIELD_LEN 128
+
+typedef struct _Exif_Fields Exif_Fields;
+
+struct _Exif_Fields
+{
+    char make[FIELD_LEN];
+    char model[FIELD_LEN];
+    char date[FIELD_LEN];
+    char title[FIELD_LEN];
+    char author[FIELD_LEN];
+    char caption[FIELD_LEN * 4];
+    char keywords[FIELD_LEN * 2];
+    double exposure;
+    double fnumber;
+    double focal;
+    int iso;
+    int flash;
+    int width;
+    int height;
+};
+
+typedef struct _Tiff Tiff;
+
+struct _Tiff
+{
+    const unsigned char *base;
+    size_t size;
+    int big_endian;
+};
+
+static unsigned int
+_u16(const Tiff *t, const unsigned char *p)
+{
+    return t->big_endian ? (p[0] << 8) | p[1] : (p[1] << 8) | p[0];
+}
+
+static unsigned int
+_u32(const Tiff *t, const unsigned char *p)
+{
+    return t->big_endian ?
+        ((unsigned int) p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3] :
+        ((unsigned int) p[3] << 24) | (p[2] << 16) | (p[1] << 8) | p[0];
+}
+
+static size_t
+_type_size(unsigned int type)
+{
+    switch (type)
+    {
+    case 1: case 2: case 6: case 7: return 1;
+    case 3: case 8:                 return 2;
+    case 4: case 9: case 11:        return 4;
+    case 5: case 10: case 12:       return 8;
+    default:                        return 0;
+    }
+}
+
+static void
+_copy_string(char *dst, size_t size, const unsigned char *src, size_t len)
+{
+    if (len >= size)
+        len = size - 1;
+    memcpy(dst, src, len);
+    dst[len] = '\0';
+    /* ASCII values are NUL terminated and often padded with spaces */
+    len = strlen(dst);
+    while (len && dst[len - 1] == ' ')
+        dst[--len] = '\0';
+}
+
+static void
+_tiff_ifd_parse(const Tiff *t, unsigned int offset, Exif_Fields *f, int depth)
+{
+    unsigned int n, i;
+
+    if (depth > 1 || offset > t->size || t->size - offset < 2)
+        return;
+
+    n = _u16(t, t->base + offset);
+    if ((size_t) n * 12 > t->size - offset - 2)
+        return;
+
+    for (i = 0; i < n; i++)
+    {
+        const unsigned char *e = t->base + offset + 2 + i * 12;
+        unsigned int tag, type, count, value;
+        const unsigned char *data;
+        size_t len;
+
+        tag   = _u16(t, e);
+        type  = _u16(t, e + 2);
+        count = _u32(t, e + 4);
+        len   = _type_size(type) * count;
+        if (!len || len / count != _type_size(type))
+            continue;
+
+        if (len <= 4)
+            data = e + 8;
+        else
+        {
+            value = _u32(t, e + 8);
+            if (value > t->size || len > t->size - value)
+                continue;
+            data = t->base + value;
+        }
+
+#define RATIONAL(d) \
+        (_u32(t, (d) + 4) ? (double) _u32(t, d) / _u32(t, (d) + 4) : 0.0)
+#define INTEGER(d) (type == 3 ? _u16(t, d) : _u32(t, d))
+
+        switch (tag)
+        {
+        case TAG_MAKE:
+            _copy_string(f->make, sizeof(f->make), data, len);
+            break;
+        case TAG_MODEL:
+            _copy_string(f->model, sizeof(f->model), data, len);
+            break;
+        case TAG_DATETIME:
+            if (!f->date[0])
+                _copy_string(f->date, sizeof(f->date), data, len);
+            break;
+        case TAG_DATETIME_ORIG:
+            _copy_string(f->date, sizeof(f->date), data, len);
+            break;
+        case TAG_EXIF_IFD:
+            _tiff_ifd_parse(t, _u32(t, data), f, depth + 1);
+            break;
+        case TAG_EXPOSURE_TIME:
+            if (type == 5)
+                f->exposure = RATIONAL(data);
+            break;
+        case TAG_FNUMBER:
+            if (type == 5)
+                f->fnumber = RATIONAL(data);
+            break;
+        case TAG_FOCAL_LENGTH:
+            if (type == 5)
+                f->focal = RATIONAL(data);
+            break;
+        case TAG_ISO:
+            f->iso = INTEGER(data);
+            break;
+        case TAG_FLASH:
+            f->flash = (INTEGER(data) & 1) + 1;
+            break;
+        case TAG_PIXEL_X:
+            f->width = INTEGER(data);
+            break;
+        case TAG_PIXEL_Y:
+            f->height = INTEGER(data);
+            break;
+        default:
+            break;
+        }
+
+#undef RATIONAL
+#undef INTEGER
+    }
+}
+
+static void
+_exif_parse(const unsigned char *p, size_t size, Exif_Fields *f)
+{
+    Tiff t;
+
+    if (size < 14 || memcmp(p, "Exif\0\0", 6))
+        return;
+
+    t.base = p + 6;
+    t.size = size - 6;
+    if (!memcmp(t.base, "MM", 2))
+        t.big_endian = 1;
+    else if (!memcmp(t.base, "II", 2))
+        t.big_endian = 0;
+    else
+        return;
+
+    if (_u16(&t, t.base + 2) != 42)
+        return;
+
+    _tiff_ifd_parse(&t, _u32(&t, t.base + 4), f, 0);
+}
+
+static void
+_iptc_parse(const unsigned char *p, size_t size, Exif_Fields *f)
+{
+    size_t i = 0;
+
+    while (i + 5 <= size)
+    {
+        unsigned int record, dataset, len;
+
+        if (p[i] != 0x1C)
+            break;
+        record  = p[i + 1];
+        dataset = p[i + 2];
+        len     = (p[i + 3] << 8) | p[i + 4];
+        i += 5;
+        if (len > size - i)
+            break;
+
+        if (record == 2)
+        {
+            switch (dataset)
+            {
+            case IPTC_OBJECT_NAME:
+                _copy_string(f->title, sizeof(f->title), p + i, len);
+                break;
+            case IPTC_BYLINE:
+                _copy_string(f->author, sizeof(f->author), p + i, len);
+                break;
+            case IPTC_CAPTION:
+                _copy_string(f->caption, sizeof(f->caption), p + i, len);
+                break;
+            case IPTC_KEYWORDS:
+            {
+                size_t l = strlen(f->keywords);
+
+                if (l && l + 2 < sizeof(f->keywords))
+                {
+                    strcpy(f->keywords + l, ", ");
+                    l += 2;
+                }
+                _copy_string(f->keywords + l, sizeof(f->keywords) - l,
+                             p + i, len);
+                break;
+            }
+            default:
+                break;
+            }
+        }
+        i += len;
+    }
+}
+
+/* Photoshop image resources, IPTC is the 0x0404 one */
+static void
+_app13_parse(const unsigned char *p, size_t size, Exif_Fields *f)
+{
+    size_t i;
+
+    if (size < 14 || memcmp(p, "Photoshop 3.0\0", 14))
+        return;
+
+    i = 14;
+    while (i + 12 <= size && !memcmp(p + i, "8BIM", 4))
+    {
+        unsigned int id, len;
+        size_t name;
+
+        id = (p[i + 4] << 8) | p[i + 5];
+        /* even padded pascal string */
+        name = (p[i + 6] + 2) & ~1U;
+        i += 6 + name;
+        if (i + 4 > size)
+            break;
+        len = ((unsigned int) p[i] << 24) | (p[i + 1] << 16) |
+              (p[i + 2] << 8) | p[i + 3];
+        i += 4;
+        if (len > size - i)
+            break;
+
+        if (id == 0x0404)
+            _iptc_parse(p + i, len, f);
+        i += (len + 1) & ~1U;
+    }
+}
+
+static void
+_jpeg_parse(const unsigned char *p, size_t size, Exif_Fields *f)
+{
+    size_t i = 2;
+
+    if (size < 4 || p[0] != 0xFF || p[1] != JPEG_SOI)
+        return;
+
+    while (i + 4 <= size)
+    {
+        unsigned int marker, len;
+
+        if (p[i] != 0xFF)
+            return;
+        marker = p[i + 1];
+        if (marker == 0xFF)
+        {
+            i++;
+            continue;
+        }
+        if (marker == JPEG_SOS || marker == JPEG_EOI)
+            return;
+
+        len = (p[i + 2] << 8) | p[i + 3];
+        if (len < 2 || len > size - i - 2)
+            return;
+
+        if (marker == JPEG_APP1)
+            _exif_parse(p + i + 4, len - 2, f);
+        else if (marker == JPEG_APP13)
+            _app13_parse(p + i + 4, len - 2, f);
+
+        i += 2 + len;
+    }
+}
+
+/* textblock markup must not be taken from the file */
+static void
+_append_escaped(Enna_Buffer *b, const char *str)
+{
+    for (; *str; str++)
+    {
+        if (*str == '<')
+            enna_buffer_append(b, "&lt;");
+        else if (*str == '>')
+            enna_buffer_append(b, "&gt;");
+        else if (*str == '&')
+            enna_buffer_append(b, "&amp;");
+        else
+            enna_buffer_append_length(b, str, 1);
+    }
+}
+
+static void
+_append_field(Enna_Buffer *b, const char *label, const char *value)
+{
+    if (!value[0])
+        return;
+
+    enna_buffer_appendf(b, "<b>%s:</b> ", label);
+    _append_escaped(b, value);
+    enna_buffer_append(b, "<br>");
+}
+
+char *
+photo_exif_text_get(const char *filename)
+{
+    Exif_Fields f;
+    Enna_Buffer b;
+    struct stat st;
+    unsigned char *map;
+    size_t size;
+    char *text = NULL;
+    char tmp[FIELD_LEN * 2];
+    int fd;
+
+    fd = open(filename, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+
+    if (fstat(fd, &st) || st.st_size < 4)
+    {
+        close(fd);
+        return NULL;
+    }
+
+    size = st.st_size < EXIF_MAP_SIZE ? (size_t) st.st_size : EXIF_MAP_SIZE;
+    map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return NULL;
+
+    memset(&f, 0, sizeof(f));
+    _jpeg_parse(map, size, &f);
+    munmap(map, size);
+
+    enna_buffer_init(&b);
+
+    snprintf(tmp, sizeof(tmp), "%s%s%s", f.make,
+             f.make[0] && f.model[0] ? " " : "", f.model);
+    _append_field(&b, _("Camera"), tmp);
+    _append_field(&b, _("Date"), f.date);
+    if (f.width && f.height)
+    {
+        snprintf(tmp, sizeof(tmp), "%dx%d", f.width, f.height);
+        _append_field(&b, _("Size"), tmp);
+    }
+    if (f.exposure > 0.0)
+    {
+        if (f.exposure < 1.0)
+            snprintf(tmp, sizeof(tmp), "1/%.0f s", 1.0 / f.exposure);
+        else
+            snprintf(tmp, sizeof(tmp), "%.1f s", f.exposure);
+        _append_field(&b, _("Exposure"), tmp);
+    }
+    if (f.fnumber > 0.0)
+    {
+        snprintf(tmp, sizeof(tmp), "f/%.1f", f.fnumber);
+        _append_field(&b, _("Aperture"), tmp);
+    }
+    if (f.focal > 0.0)
+    {
+        snprintf(tmp, sizeof(tmp), "%.0f mm", f.focal);
+        _append_field(&b, _("Focal length"), tmp);
+    }
+    if (f.iso)
+    {
+        snprintf(tmp, sizeof(tmp), "%d", f.iso);
+        _append_field(&b, _("ISO"), tmp);
+    }
+    if (f.flash)
+        _append_field(&b, _("Flash"), f.flash == 2 ? _("Yes") : _("No"));
+    _append_field(&b, _("Title"), f.title);
+    _append_field(&b, _("Author"), f.author);
+    _append_field(&b, _("Caption"), f.caption);
+    _append_field(&b, _("Keywords"), f.keywords);
+
+    if (b.buf)
+        text = strdup(b.buf);
+    enna_buffer_release(&b);
+
+    return text;
+}
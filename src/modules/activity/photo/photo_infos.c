@@ -27,16 +27,32 @@
 #include "metadata.h"
 #include "logs.h"
 #include "photo_infos.h"
+#include "photo_exif.h"
 
 #define SMART_NAME "photo_panel_infos"
 
+/* parsed files kept, the oldest ones are dropped first */
+#define EXIF_CACHE_MAX 1024
+
 typedef struct _Smart_Data Smart_Data;
+typedef struct _Exif_Job Exif_Job;
 
 struct _Smart_Data
 {
     Evas_Coord x, y, w, h;
     Evas_Object *o_edje;
     Evas_Object *o_pict;
+    Eina_Hash *cache;     /* filename -> formatted text, "" if none */
+    Eina_List *cache_fifo;
+    Eina_List *jobs;      /* running jobs, the last one is displayed */
+    Exif_Job *job;
+};
+
+struct _Exif_Job
+{
+    Smart_Data *sd;       /* NULL once the panel is deleted */
+    char *filename;
+    char *text;
 };
 
 /* local subsystem globals */
@@ -68,15 +84,24 @@ static void _smart_add(Evas_Object * obj)
     edje_object_file_set(sd->o_edje, enna_config_theme_get(),
                          "activity/photo/panel_infos");
     evas_object_show(sd->o_edje);
+    sd->cache = eina_hash_string_superfast_new(free);
     evas_object_smart_member_add(sd->o_edje, obj);
     evas_object_smart_data_set(obj, sd);
 }
 
 static void _smart_del(Evas_Object * obj)
 {
+    const char *key;
+    Exif_Job *job;
+
     INTERNAL_ENTRY;
+    EINA_LIST_FREE(sd->jobs, job)
+        job->sd = NULL;
     ENNA_OBJECT_DEL(sd->o_edje);
     ENNA_OBJECT_DEL(sd->o_pict);
+    eina_hash_free(sd->cache);
+    EINA_LIST_FREE(sd->cache_fifo, key)
+        eina_stringshare_del(key);
     free(sd);
 }
 
@@ -167,22 +192,14 @@ photo_panel_infos_add(Evas * evas)
 /*                          Information Panel                               */
 /****************************************************************************/
 
-void
-photo_panel_infos_set_text (Evas_Object *obj, const char *filename)
+/* Files without EXIF fall back on the metadata of the database */
+static char *
+_metadata_text_get(const char *filename)
 {
     Enna_Metadata *m;
     const char *meta;
     char *meta2 = NULL;
 
-    API_ENTRY return;
-
-    if (!filename || !ecore_file_exists(filename))
-    {
-        edje_object_part_text_set (sd->o_edje, "infos.panel.textblock",
-	    _("No EXIF information found ..."));
-        return;
-    }
-
     m = enna_metadata_meta_new (filename);
     meta = enna_metadata_meta_get_all (m);
     if (meta)
@@ -208,12 +225,143 @@ photo_panel_infos_set_text (Evas_Object *obj, const char *filename)
         }
     }
 
-    edje_object_part_text_set (sd->o_edje, "infos.panel.textblock",
-                               meta2 ? meta2:
-                               _("No EXIF such information found ..."));
     eina_stringshare_del(meta);
-    ENNA_FREE (meta2);
     enna_metadata_meta_free (m);
+    return meta2;
+}
+
+static void
+_text_set(Smart_Data *sd, const char *text)
+{
+    edje_object_part_text_set (sd->o_edje, "infos.panel.textblock",
+                               text && text[0] ? text :
+                               _("No EXIF such information found ..."));
+}
+
+static void
+_cache_add(Smart_Data *sd, const char *filename, char *text)
+{
+    const char *old;
+
+    if (eina_hash_find(sd->cache, filename))
+    {
+        free(text);
+        return;
+    }
+
+    if (eina_list_count(sd->cache_fifo) >= EXIF_CACHE_MAX)
+    {
+        old = eina_list_data_get(sd->cache_fifo);
+        sd->cache_fifo = eina_list_remove_list(sd->cache_fifo, sd->cache_fifo);
+        eina_hash_del_by_key(sd->cache, old);
+        eina_stringshare_del(old);
+    }
+
+    eina_hash_add(sd->cache, filename, text ? text : strdup(""));
+    sd->cache_fifo = eina_list_append(sd->cache_fifo,
+                                      eina_stringshare_add(filename));
+}
+
+static void
+_exif_job_free(Exif_Job *job)
+{
+    free(job->filename);
+    free(job->text);
+    free(job);
+}
+
+static void
+_exif_heavy_cb(void *data, Ecore_Thread *thread EINA_UNUSED)
+{
+    Exif_Job *job = data;
+
+    job->text = photo_exif_text_get(job->filename);
+}
+
+static void
+_exif_end_cb(void *data, Ecore_Thread *thread EINA_UNUSED)
+{
+    Exif_Job *job = data;
+    Smart_Data *sd = job->sd;
+
+    if (!sd)
+    {
+        _exif_job_free(job);
+        return;
+    }
+
+    sd->jobs = eina_list_remove(sd->jobs, job);
+    if (sd->job == job)
+    {
+        sd->job = NULL;
+        if (!job->text)
+            job->text = _metadata_text_get(job->filename);
+        _text_set(sd, job->text);
+    }
+
+    /* results of superseded jobs are kept too, unless the database is
+     * needed: it is only queried for the displayed file */
+    if (job->text)
+    {
+        _cache_add(sd, job->filename, job->text);
+        job->text = NULL;
+    }
+    _exif_job_free(job);
+}
+
+static void
+_exif_cancel_cb(void *data, Ecore_Thread *thread EINA_UNUSED)
+{
+    Exif_Job *job = data;
+
+    if (job->sd)
+    {
+        job->sd->jobs = eina_list_remove(job->sd->jobs, job);
+        if (job->sd->job == job)
+            job->sd->job = NULL;
+    }
+    _exif_job_free(job);
+}
+
+/*
+ * The panel follows the highlight: the fields are parsed on a worker and
+ * kept per file, a highlight move only sets a cached text or starts a
+ * job. Only the last job started updates the panel.
+ */
+void
+photo_panel_infos_set_text (Evas_Object *obj, const char *filename)
+{
+    Exif_Job *job;
+    const char *text;
+
+    API_ENTRY return;
+
+    sd->job = NULL;
+
+    if (!filename)
+    {
+        edje_object_part_text_set (sd->o_edje, "infos.panel.textblock",
+	    _("No EXIF information found ..."));
+        return;
+    }
+
+    text = eina_hash_find(sd->cache, filename);
+    if (text)
+    {
+        _text_set(sd, text);
+        return;
+    }
+
+    job = calloc(1, sizeof(Exif_Job));
+    if (!job)
+        return;
+    job->sd = sd;
+    job->filename = strdup(filename);
+
+    edje_object_part_text_set (sd->o_edje, "infos.panel.textblock", "");
+    sd->job = job;
+    sd->jobs = eina_list_append(sd->jobs, job);
+    ecore_thread_run(_exif_heavy_cb, _exif_end_cb, _exif_cancel_cb, job);
 }
 
 void
@@ -21,16 +21,46 @@
 
 /* TODO : remove smart object and use directly elm objects */
 
+#include <stdint.h>
+#include <string.h>
+
 #include <Elementary.h>
 
 #include "enna_config.h"
 #include "input.h"
+#include "logs.h"
+#include "file.h"
 #include "photo_slideshow_view.h"
 
 #undef FEATURE_ROTATION
 
 #define ROTATION_DURATION 0.5
 
+#define PREFETCH_NEXT_DEFAULT   2
+#define PREFETCH_PREV_DEFAULT   1
+#define PREFETCH_MEMORY_DEFAULT 96 /* MB */
+
+/* decode size used until the layout has been sized */
+#define DECODE_DEFAULT_W 1920
+#define DECODE_DEFAULT_H 1080
+/* assumed size of a full resolution slide until one has been decoded */
+#define DECODE_FULL_ESTIMATE (4000 * 3000 * 4)
+
+/* slides registered in the slideshow per idler call */
+#define SLIDES_CHUNK  64
+/* slides before the first shown one registered right away */
+#define SLIDES_BEFORE 16
+
+typedef struct photo_cfg_s {
+    int prefetch_next;
+    int prefetch_prev;
+    int prefetch_memory;
+    Eina_Bool decode_full;
+    Eina_Bool zoom;
+} photo_cfg_t;
+
+static photo_cfg_t photo_cfg;
+
 typedef struct _Smart_Data Smart_Data;
 
 struct _Smart_Data
@@ -41,9 +71,23 @@ struct _Smart_Data
     Evas_Object *slideshow;
     Evas_Object *event_rect;
     Input_Listener *listener;
-    Eina_List *items;
+    /* files of the slideshow, the items are registered lazily */
+    Enna_File **files;
+    Elm_Object_Item **items;
+    unsigned int count;
+    unsigned int size;
+    unsigned int registered;
+    unsigned int first;
+    Ecore_Idler *idler;
     Evas_Object *btplay;
     Evas_Object *spin;
+    Evas_Object *zoom;
+    Evas_Coord decode_w;
+    Evas_Coord decode_h;
+    /* decoded pixels currently held by the slides and the zoom */
+    size_t mem_slides;
+    unsigned int nb_slides;
+    size_t mem_zoom;
     int delay;
     double start;
     Ecore_Animator *animator;
@@ -217,21 +261,89 @@ _spin(void *data, Evas_Object *obj EINA_UNUSED, void *event_info EINA_UNUSED)
         elm_slideshow_timeout_set(sd->slideshow, sd->delay);
 }
 
+static void _mouse_wheel_cb(void *data, Evas *e, Evas_Object *obj, void *event_info);
+
+static void
+_mem_log(Smart_Data *sd)
+{
+    enna_log(ENNA_MSG_EVENT, "slideshow",
+             "%u slides decoded in %lu kB, zoom %lu kB", sd->nb_slides,
+             (unsigned long) sd->mem_slides / 1024,
+             (unsigned long) sd->mem_zoom / 1024);
+}
+
+static void
+_zoom_loaded_cb(void *data, Evas_Object *obj, void *event_info EINA_UNUSED)
+{
+    Smart_Data *sd = data;
+    int w = 0, h = 0;
+
+    elm_photocam_image_size_get(obj, &w, &h);
+    sd->mem_zoom = (size_t) w * h * 4;
+    _mem_log(sd);
+}
+
+static void
+_zoom_del(Smart_Data *sd)
+{
+    ENNA_OBJECT_DEL(sd->zoom);
+    sd->mem_zoom = 0;
+}
+
+/* Slides are decoded at screen size, zooming switches to a full resolution
+ * photocam laid over the current slide until the slide changes. */
+static Evas_Object *
+_zoom_get(Smart_Data *sd)
+{
+    Elm_Object_Item *item;
+    Evas_Coord x, y, w, h;
+
+    if (sd->zoom)
+        return sd->zoom;
+
+    if (!photo_cfg.zoom)
+        return NULL;
+
+    item = elm_slideshow_item_current_get(sd->slideshow);
+    if (!item)
+        return NULL;
+
+    sd->zoom = elm_photocam_add(sd->layout);
+    elm_photocam_zoom_mode_set(sd->zoom, ELM_PHOTOCAM_ZOOM_MODE_AUTO_FIT);
+    evas_object_smart_callback_add(sd->zoom, "loaded", _zoom_loaded_cb, sd);
+    elm_photocam_file_set(sd->zoom, elm_object_item_data_get(item));
+
+    evas_object_geometry_get(sd->slideshow, &x, &y, &w, &h);
+    evas_object_move(sd->zoom, x, y);
+    evas_object_resize(sd->zoom, w, h);
+    evas_object_event_callback_add(sd->zoom, EVAS_CALLBACK_MOUSE_WHEEL,
+                                   _mouse_wheel_cb, sd);
+    evas_object_show(sd->zoom);
+
+    return sd->zoom;
+}
+
+static void
+_slideshow_changed_cb(void *data, Evas_Object *obj EINA_UNUSED, void *event_info EINA_UNUSED)
+{
+    Smart_Data *sd = data;
+
+    _zoom_del(sd);
+}
+
 static void
 _mouse_wheel_cb(void *data, Evas *e EINA_UNUSED, Evas_Object *obj EINA_UNUSED, void *event_info)
 {
     Smart_Data *sd = data;
     Evas_Object *photocam;
-    Elm_Object_Item *item;
     Evas_Event_Mouse_Wheel *ev = (Evas_Event_Mouse_Wheel*) event_info;
     double zoom;
 
     //unset the mouse wheel
     ev->event_flags |= EVAS_EVENT_FLAG_ON_HOLD;
 
-    item = elm_slideshow_item_current_get(sd->slideshow);
-    if(!item) return ;
-    photocam = elm_slideshow_item_object_get(item);
+    photocam = _zoom_get(sd);
+    if (!photocam) return ;
 
     zoom = elm_photocam_zoom_get(photocam);
 
@@ -295,24 +407,126 @@ _input_events_cb(void *data, enna_input event)
     return ENNA_EVENT_CONTINUE;
 }
 
+static void _prefetch_window_set(Smart_Data *sd);
+
+/* Each slide accounts for the surface it really decoded */
+static void
+_slide_preloaded_cb(void *data, Evas *e EINA_UNUSED, Evas_Object *obj, void *event_info EINA_UNUSED)
+{
+    Smart_Data *sd = data;
+    int w = 0, h = 0;
+    size_t bytes;
+
+    if (evas_object_data_get(obj, "slide_bytes"))
+        return;
+
+    evas_object_image_size_get(obj, &w, &h);
+    bytes = (size_t) w * h * 4;
+    evas_object_data_set(obj, "slide_bytes", (void *) (uintptr_t) bytes);
+
+    sd->mem_slides += bytes;
+    sd->nb_slides++;
+    _mem_log(sd);
+
+    /* a full resolution window is sized from what was really decoded */
+    if (photo_cfg.decode_full && sd->nb_slides == 1)
+        _prefetch_window_set(sd);
+}
+
+static void
+_slide_del_cb(void *data, Evas *e EINA_UNUSED, Evas_Object *obj, void *event_info EINA_UNUSED)
+{
+    Smart_Data *sd = data;
+    size_t bytes;
+
+    bytes = (uintptr_t) evas_object_data_get(obj, "slide_bytes");
+    if (!bytes)
+        return;
+
+    sd->mem_slides -= bytes;
+    sd->nb_slides--;
+}
+
+/*
+ * The slideshow realizes the objects of the items inside its cache window
+ * (PREFETCH_PREV before and PREFETCH_NEXT after the current one) ahead of
+ * time and deletes the ones leaving it. Each object decodes its picture in
+ * the evas async loader, at screen size unless decode=full, so the next
+ * slide is usually ready before it is shown.
+ */
 static Evas_Object *
 _slideshow_item_get(void *data, Evas_Object *obj)
 {
-    Evas_Object *im;
-    im = elm_photocam_add(obj);
-    elm_photocam_zoom_mode_set(im,ELM_PHOTOCAM_ZOOM_MODE_AUTO_FIT);
-    elm_photocam_file_set(im, data);
+    Smart_Data *sd = evas_object_data_get(obj, "sd");
+    Evas_Object *im, *img;
+
+    im = elm_image_add(obj);
+    elm_image_resizable_set(im, EINA_TRUE, EINA_TRUE);
+    img = elm_image_object_get(im);
+    /* the jpeg loader scales in the DCT for a smaller load size */
+    if (!photo_cfg.decode_full)
+        evas_object_image_load_size_set(img, sd->decode_w, sd->decode_h);
+    evas_object_event_callback_add(img, EVAS_CALLBACK_IMAGE_PRELOADED,
+                                   _slide_preloaded_cb, sd);
+    evas_object_event_callback_add(img, EVAS_CALLBACK_DEL,
+                                   _slide_del_cb, sd);
+    elm_image_file_set(im, data, NULL);
+    elm_image_preload_disabled_set(im, EINA_FALSE);
     return im;
 }
 
+/* Shrink the window until the decoded slides fit in the memory budget */
+static void
+_prefetch_window_set(Smart_Data *sd)
+{
+    int next = photo_cfg.prefetch_next;
+    int prev = photo_cfg.prefetch_prev;
+    size_t slide, budget;
+
+    if (sd->nb_slides)
+        slide = sd->mem_slides / sd->nb_slides;
+    else if (photo_cfg.decode_full)
+        slide = DECODE_FULL_ESTIMATE;
+    else
+        slide = (size_t) sd->decode_w * sd->decode_h * 4;
+    budget = (size_t) photo_cfg.prefetch_memory * 1024 * 1024;
+
+    while ((size_t) (next + prev + 1) * slide > budget && (next || prev))
+    {
+        if (prev)
+            prev--;
+        else
+            next--;
+    }
+
+    elm_slideshow_cache_before_set(sd->slideshow, prev);
+    elm_slideshow_cache_after_set(sd->slideshow, next);
+
+    if (photo_cfg.decode_full)
+        enna_log(ENNA_MSG_EVENT, "slideshow",
+                 "decoding at full resolution, "
+                 "prefetching %d next and %d previous", next, prev);
+    else
+        enna_log(ENNA_MSG_EVENT, "slideshow",
+                 "decoding at %dx%d, prefetching %d next and %d previous",
+                 sd->decode_w, sd->decode_h, next, prev);
+}
+
 static void
 _sd_del(void *data, Evas *e EINA_UNUSED, Evas_Object *obj EINA_UNUSED, void *event_info EINA_UNUSED)
 {
     Smart_Data *sd = data;
+    unsigned int i;
 
+    _zoom_del(sd);
     ENNA_OBJECT_DEL(sd->controls);
     ENNA_OBJECT_DEL(sd->slideshow);
-    eina_list_free(sd->items);
+    if (sd->idler)
+        ecore_idler_del(sd->idler);
+    for (i = 0; i < sd->count; i++)
+        enna_file_free(sd->files[i]);
+    ENNA_FREE(sd->files);
+    ENNA_FREE(sd->items);
     enna_input_listener_del(sd->listener);
     ENNA_FREE(sd);
 }
@@ -339,7 +553,108 @@ static Elm_Slideshow_Item_Class itc =
     }
 };
 
+/*
+ * The slideshow loops, so registering the items in the rotated order
+ * first, first + 1, ..., count - 1, 0, ..., first - 1 keeps the same
+ * navigation while only appending. first is a few slides before the one
+ * shown at start-up so that going back works while the idler catches up.
+ */
+static void
+_slides_register(Smart_Data *sd, unsigned int n)
+{
+    unsigned int i;
+
+    for (; n && sd->registered < sd->count; n--, sd->registered++)
+    {
+        i = (sd->first + sd->registered) % sd->count;
+        sd->items[i] = elm_slideshow_item_add(sd->slideshow, &itc,
+                                              enna_file_mrl_get(sd->files[i]) + 7);
+    }
+}
+
+static Eina_Bool
+_slides_idler_cb(void *data)
+{
+    Smart_Data *sd = data;
+
+    _slides_register(sd, SLIDES_CHUNK);
+    if (sd->registered < sd->count)
+        return ECORE_CALLBACK_RENEW;
+
+    sd->idler = NULL;
+    return ECORE_CALLBACK_CANCEL;
+}
+
+static void
+cfg_photo_section_load(const char *section)
+{
+    const char *value;
+    int v;
+
+    /* 0 is a valid window size, only negative values are ignored */
+    if (enna_config_string_get(section, "prefetch_next"))
+    {
+        v = enna_config_int_get(section, "prefetch_next");
+        if (v >= 0)
+            photo_cfg.prefetch_next = v;
+    }
+    if (enna_config_string_get(section, "prefetch_prev"))
+    {
+        v = enna_config_int_get(section, "prefetch_prev");
+        if (v >= 0)
+            photo_cfg.prefetch_prev = v;
+    }
+
+    v = enna_config_int_get(section, "prefetch_memory");
+    if (v > 0)
+        photo_cfg.prefetch_memory = v;
+
+    value = enna_config_string_get(section, "decode");
+    if (value)
+        photo_cfg.decode_full = !strcmp(value, "full");
+
+    if (enna_config_string_get(section, "zoom"))
+        photo_cfg.zoom = enna_config_bool_get(section, "zoom");
+}
+
+static void
+cfg_photo_section_save(const char *section)
+{
+    enna_config_int_set(section, "prefetch_next", photo_cfg.prefetch_next);
+    enna_config_int_set(section, "prefetch_prev", photo_cfg.prefetch_prev);
+    enna_config_int_set(section, "prefetch_memory", photo_cfg.prefetch_memory);
+    enna_config_string_set(section, "decode",
+                           photo_cfg.decode_full ? "full" : "screen");
+    enna_config_bool_set(section, "zoom", photo_cfg.zoom);
+}
+
+static void
+cfg_photo_section_set_default(void)
+{
+    photo_cfg.prefetch_next   = PREFETCH_NEXT_DEFAULT;
+    photo_cfg.prefetch_prev   = PREFETCH_PREV_DEFAULT;
+    photo_cfg.prefetch_memory = PREFETCH_MEMORY_DEFAULT;
+    photo_cfg.decode_full     = EINA_FALSE;
+    photo_cfg.zoom            = EINA_TRUE;
+}
+
+static Enna_Config_Section_Parser cfg_photo = {
+    "photo",
+    cfg_photo_section_load,
+    cfg_photo_section_save,
+    cfg_photo_section_set_default,
+    NULL,
+};
+
 /* externally accessible functions */
+void
+enna_photo_slideshow_cfg_register(void)
+{
+    enna_config_section_parser_register(&cfg_photo);
+    cfg_photo_section_set_default();
+    cfg_photo_section_load(cfg_photo.section);
+}
+
 Evas_Object *
 enna_photo_slideshow_add(Evas_Object *parent)
 {
@@ -359,12 +674,19 @@ enna_photo_slideshow_add(Evas_Object *parent)
     sd->slideshow = elm_slideshow_add(sd->layout);
     elm_slideshow_transition_set(sd->slideshow, "horizontal");
     elm_slideshow_loop_set(sd->slideshow, 1);
+    evas_object_data_set(sd->slideshow, "sd", sd);
+    evas_object_smart_callback_add(sd->slideshow, "changed",
+                                   _slideshow_changed_cb, sd);
 
 //    sd->controls = elm_notify_add(sd->layout);
 //    elm_notify_orient_set(sd->controls, ELM_NOTIFY_ORIENT_BOTTOM);
     evas_object_geometry_get(enna->layout, NULL, NULL, &w, &h);
     evas_object_move(sd->controls, 0, 0);
     evas_object_resize(sd->controls, w, h);
+
+    sd->decode_w = w > 0 ? w : DECODE_DEFAULT_W;
+    sd->decode_h = h > 0 ? h : DECODE_DEFAULT_H;
+    _prefetch_window_set(sd);
     //elm_object_style_set(sd->controls, "enna_bottom");
     /* Fixme : add a config value */
 //    elm_notify_timeout_set(sd->controls, 10);
@@ -408,7 +730,10 @@ enna_photo_slideshow_add(Evas_Object *parent)
     evas_object_event_callback_add(sd->layout, EVAS_CALLBACK_MOUSE_WHEEL,
                                    _mouse_wheel_cb, sd);
     /* connect to the input signal */
-    sd->listener = enna_input_listener_add("slideshow", _input_events_cb, sd->layout);
+    sd->listener = enna_input_listener_add_full("slideshow",
+                                                ENNA_INPUT_PRIORITY_NORMAL,
+                                                ENNA_INPUT_MASK_NAVIGATION,
+                                                _input_events_cb, sd->layout);
     enna_input_listener_demote(sd->listener);
 
     evas_object_event_callback_add(sd->layout, EVAS_CALLBACK_MOUSE_UP, _controls_show, sd);
@@ -443,19 +768,54 @@ void enna_photo_slideshow_timeout_set(Evas_Object *obj, int to)
     elm_slideshow_timeout_set(sd->slideshow, to);
 }
 
-void enna_photo_slideshow_image_add(Evas_Object *obj, const char *file, const char *group EINA_UNUSED)
+void enna_photo_slideshow_file_add(Evas_Object *obj, Enna_File *file)
 {
-    Elm_Object_Item *it;
     Smart_Data *sd = evas_object_data_get(obj, "sd");
-    it = elm_slideshow_item_add(sd->slideshow, &itc, file);
-    sd->items = eina_list_append(sd->items, it);
+
+    /* items can not be added once the registration started */
+    if (sd->registered)
+        return;
+
+    if (sd->count == sd->size)
+    {
+        Enna_File **files;
+        Elm_Object_Item **items;
+        unsigned int size = sd->size ? 2 * sd->size : SLIDES_CHUNK;
+
+        files = realloc(sd->files, size * sizeof(Enna_File *));
+        if (!files)
+            return;
+        sd->files = files;
+        items = realloc(sd->items, size * sizeof(Elm_Object_Item *));
+        if (!items)
+            return;
+        sd->items = items;
+        sd->size = size;
+    }
+
+    sd->files[sd->count] = enna_file_ref(file);
+    sd->items[sd->count] = NULL;
+    sd->count++;
 }
 
 void enna_photo_slideshow_goto(Evas_Object *obj, int nth)
 {
-    Elm_Object_Item *it;
     Smart_Data *sd = evas_object_data_get(obj, "sd");
 
-    it = eina_list_nth(sd->items, nth);
-    elm_slideshow_item_show(it);
+    if (nth < 0 || (unsigned int) nth >= sd->count)
+        return;
+
+    if (!sd->registered)
+    {
+        sd->first = (nth + sd->count - SLIDES_BEFORE % sd->count) % sd->count;
+        sd->idler = ecore_idler_add(_slides_idler_cb, sd);
+    }
+
+    /* the registration goes on in the idler, catch up if needed */
+    while (!sd->items[nth] && sd->registered < sd->count)
+        _slides_register(sd, SLIDES_CHUNK);
+
+    /* the slide may have failed to register */
+    if (sd->items[nth])
+        elm_slideshow_item_show(sd->items[nth]);
 }
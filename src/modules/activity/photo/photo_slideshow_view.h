@@ -22,12 +22,15 @@
 #ifndef PHOTO_SLIDESHOW_VIEW_H
 #define PHOTO_SLIDESHOW_VIEW_H
 
+#include "file.h"
+
+void enna_photo_slideshow_cfg_register(void);
 Evas_Object *enna_photo_slideshow_add(Evas_Object *parent);
 void enna_photo_slideshow_next(Evas_Object *obj);
 void enna_photo_slideshow_previous(Evas_Object *obj);
 int enna_photo_slideshow_timeout_get(Evas_Object *obj);
 void enna_photo_slideshow_timeout_set(Evas_Object *obj, int to);
-void enna_photo_slideshow_image_add(Evas_Object *obj, const char *file, const char *group);
+void enna_photo_slideshow_file_add(Evas_Object *obj, Enna_File *file);
 void enna_photo_slideshow_goto(Evas_Object *obj, int nth);
 
 #endif /* PHOTO_SLIDESHOW_VIEW_H */
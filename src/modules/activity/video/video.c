@@ -37,6 +37,8 @@
 #include "volumes.h"
 #include "buffer.h"
 #include "metadata.h"
+#include "resume.h"
+#include "artwork.h"
 #include "utils.h"
 #include "mediaplayer_obj.h"
 #include "videoplayer_obj.h"
@@ -50,6 +52,8 @@
 #define ENNA_MODULE_NAME "video"
 
 #define TIMER_DELAY 10.0
+/* interval between two saves of the resume point during playback */
+#define RESUME_CHECKPOINT 30.0
 
 static void browser_cb_root(void *data, Evas_Object *obj, void *event_info);
 static void browser_cb_select(void *data, Evas_Object *obj, void *event_info);
@@ -87,6 +91,8 @@ struct _Enna_Module_Video
     int controls_displayed;
     Enna_Volumes_Listener *vl;
     Ecore_Timer *controls_timer;
+    Ecore_Timer *resume_timer;
+    Ecore_Idler *prefetch_idler;
     Ecore_Event_Handler *mouse_button_event_handler;
     Ecore_Event_Handler *mouse_move_event_handler;
     Enna_File *file;
@@ -95,25 +101,14 @@ struct _Enna_Module_Video
 static Enna_Module_Video *mod;
 
 static void
-update_movies_counter(Eina_List *list)
+update_movies_counter(int children)
 {
-    Enna_File *f;
-    Eina_List *l;
-    int children = 0;
     char label[128] = { 0 };
     Evas_Object *o_edje;
 
-    if (!list)
-        goto end;
-
-    EINA_LIST_FOREACH(list, l, f)
-    {
-        if (!ENNA_FILE_IS_BROWSABLE(f))
-            children++;
-    }
     if (children)
         snprintf(label, sizeof(label), _("%d Movies"), children);
-end:
+
     o_edje = elm_layout_edje_get(mod->o_layout);
     edje_object_part_text_set(o_edje, "movies.counter.label", label);
 }
@@ -229,18 +224,32 @@ popup_resume_display(int show)
 }
 
 static void
-_return_to_video_info_gui()
+_resume_checkpoint(void)
 {
-    Enna_Metadata *m;
-    double pos;
+    if (!mod->o_mediaplayer || !mod->o_current_uri)
+        return;
+
+    enna_resume_position_set(mod->o_current_uri,
+        enna_view_player_video_position_get(mod->o_mediaplayer));
+}
 
+/* a crash or a power cut must not lose more than one interval */
+static Eina_Bool
+_resume_timer_cb(void *data EINA_UNUSED)
+{
+    _resume_checkpoint();
+    return ECORE_CALLBACK_RENEW;
+}
+
+static void
+_return_to_video_info_gui()
+{
     media_controls_display(0);
     ENNA_TIMER_DEL(mod->controls_timer);
+    ENNA_TIMER_DEL(mod->resume_timer);
+    _resume_checkpoint();
     ENNA_OBJECT_DEL(mod->o_mediaplayer);
     popup_resume_display (0);
-    m = enna_mediaplayer_metadata_get(mod->enna_playlist);
-    pos = enna_mediaplayer_position_get();
-    enna_metadata_set_position(m, pos);
     enna_mediaplayer_stop();
     mod->state = BROWSER_VIEW;
 }
@@ -249,6 +258,9 @@ static void
 _eos_cb(void *data EINA_UNUSED, Evas_Object *o EINA_UNUSED, void *event_info EINA_UNUSED)
 {
     _return_to_video_info_gui();
+    /* watched until the end, nothing to resume */
+    if (mod->o_current_uri)
+        enna_resume_position_set(mod->o_current_uri, 0.0);
 }
 
 /****************************************************************************/
@@ -256,12 +268,27 @@ _eos_cb(void *data EINA_UNUSED, Evas_Object *o EINA_UNUSED, void *event_info EIN
 /****************************************************************************/
 
 
+/* screen sized derivative of the fanart */
+static const char *
+_backdrop_get(Enna_File *file)
+{
+    const char *fanart, *backdrop;
+
+    fanart = enna_file_meta_get(file, "fanart");
+    if (!fanart)
+        return NULL;
+
+    backdrop = enna_artwork_get(fanart, ENNA_ARTWORK_BACKDROP);
+    eina_stringshare_del(fanart);
+    return backdrop;
+}
+
 static void
 backdrop_show(Enna_File *file)
 {
     const char *backdrop;
 
-    backdrop = enna_file_meta_get(file, "fanart");
+    backdrop = _backdrop_get(file);
     if (backdrop)
     {
         enna_video_picture_set(mod->o_backdrop, backdrop, 1);
@@ -276,6 +303,42 @@ backdrop_show(Enna_File *file)
 
 
 
+static void
+backdrop_prefetch(Enna_File *file)
+{
+    const char *backdrop;
+
+    if (!file || ENNA_FILE_IS_BROWSABLE(file))
+        return;
+
+    backdrop = _backdrop_get(file);
+    if (!backdrop)
+        return;
+
+    enna_video_picture_prefetch(mod->o_backdrop, backdrop);
+    eina_stringshare_del(backdrop);
+}
+
+/* The neighbours of the highlighted movie are decoded once the main loop
+ * is idle, so that moving the highlight by one row finds them ready */
+static Eina_Bool
+_backdrop_prefetch_idler_cb(void *data EINA_UNUSED)
+{
+    Eina_List *l;
+
+    mod->prefetch_idler = NULL;
+
+    l = eina_list_data_find_list(enna_browser_obj_files_get(mod->o_browser),
+                                 mod->file);
+    if (!l)
+        return ECORE_CALLBACK_CANCEL;
+
+    backdrop_prefetch(eina_list_data_get(eina_list_next(l)));
+    backdrop_prefetch(eina_list_data_get(eina_list_prev(l)));
+
+    return ECORE_CALLBACK_CANCEL;
+}
+
 /****************************************************************************/
 /*                               Snapshot                                   */
 /****************************************************************************/
@@ -357,7 +420,7 @@ browser_view_event(enna_input event)
 
     if (event == ENNA_INPUT_BACK)
     {
-        update_movies_counter(NULL);
+        update_movies_counter(0);
     }
     enna_browser_obj_input_feed(mod->o_browser, event);
 }
@@ -418,16 +481,15 @@ movie_start_playback(int resume)
                                    _mediaplayer_resize_cb, NULL);
 
     media_controls_display(1);
-#if 0
     if (resume)
-    {
-        Enna_Metadata *m;
-        m = enna_mediaplayer_metadata_get(mod->enna_playlist);
-        enna_mediaplayer_position_set(m->position);
-    }
-#endif
+        enna_view_player_video_resume_set(mod->o_mediaplayer,
+            enna_resume_position_get(mod->o_current_uri));
     popup_resume_display(0);
     enna_view_player_video_play(mod->o_mediaplayer);
+
+    ENNA_TIMER_DEL(mod->resume_timer);
+    mod->resume_timer =
+        ecore_timer_add(RESUME_CHECKPOINT, _resume_timer_cb, NULL);
 }
 
 static void
@@ -441,28 +503,29 @@ browser_cb_select(void *data EINA_UNUSED, Evas_Object *obj EINA_UNUSED, void *ev
     if (ENNA_FILE_IS_BROWSABLE(file))
     {
         enna_log (ENNA_MSG_EVENT,
-                  ENNA_MODULE_NAME, "Directory Selected %s", file->uri);
-        update_movies_counter(enna_browser_obj_files_get(mod->o_browser));
+                  ENNA_MODULE_NAME, "Directory Selected %s", enna_file_uri_get(file));
+        update_movies_counter(enna_browser_obj_count_get(mod->o_browser,
+                                             ENNA_BROWSER_COUNT_FILES));
     }
     else
     {
-        Enna_Metadata *m;
+        double position;
+
         enna_log(ENNA_MSG_EVENT,
-                 ENNA_MODULE_NAME, "File Selected %s", file->uri);
+                 ENNA_MODULE_NAME, "File Selected %s", enna_file_uri_get(file));
 
-        mod->o_current_uri = strdup(file->mrl);
+        ENNA_FREE(mod->o_current_uri);
+        mod->o_current_uri = strdup(enna_file_mrl_get(file));
         mod->file = file;
-        /* fetch new stream's metadata */
-        m = enna_mediaplayer_metadata_get(mod->enna_playlist);
-#if 0
-        if (m->position)
+
+        position = enna_resume_position_get(mod->o_current_uri);
+        if (position > 0.0 && mod->o_resume)
         {
             /* stream has already been played once, show resume popup */
             popup_resume_display(1);
         }
         else
-#endif
-            movie_start_playback(0);
+            movie_start_playback(position > 0.0);
     }
 }
 
@@ -490,6 +553,10 @@ browser_cb_delay_hilight(void *data EINA_UNUSED, Evas_Object *obj EINA_UNUSED, v
 
     enna_infos_file_set(mod->o_panel_infos, mod->file);
     backdrop_show(mod->file);
+
+    if (!mod->prefetch_idler)
+        mod->prefetch_idler =
+            ecore_idler_add(_backdrop_prefetch_idler_cb, NULL);
 }
 
 static void
@@ -649,6 +716,9 @@ em_shutdown(Enna_Module *em EINA_UNUSED)
                                    "delay,hilight", browser_cb_delay_hilight);
     ENNA_EVENT_HANDLER_DEL(mod->mouse_button_event_handler);
     ENNA_EVENT_HANDLER_DEL(mod->mouse_move_event_handler);
+    ENNA_TIMER_DEL(mod->resume_timer);
+    if (mod->prefetch_idler)
+        ecore_idler_del(mod->prefetch_idler);
     ENNA_OBJECT_DEL(mod->o_browser);
     ENNA_OBJECT_DEL(mod->o_mediaplayer);
     ENNA_OBJECT_DEL(mod->o_backdrop);
@@ -28,6 +28,7 @@
 #include "logs.h"
 #include "buffer.h"
 #include "utils.h"
+#include "artwork.h"
 
 #define SMART_NAME "enna_panel_infos"
 
@@ -243,7 +244,12 @@ enna_panel_infos_set_cover(Evas_Object *obj, Enna_Metadata *m)
         snprintf(dst, sizeof(dst), "%s/covers/%s",
                  enna_util_data_home_get(), cv);
         if (ecore_file_exists(dst))
-            file = strdup(dst);
+        {
+            const char *art = enna_artwork_get(dst, ENNA_ARTWORK_PANEL);
+
+            file = strdup(art);
+            eina_stringshare_del(art);
+        }
     }
 
     if (!file)
@@ -275,7 +281,7 @@ enna_panel_infos_set_cover(Evas_Object *obj, Enna_Metadata *m)
                             "shadow,hide" : "shadow,show", "enna");
 
     eina_stringshare_del(cv);
-    eina_stringshare_del(file);
+    free(file);
 }
 
 void
@@ -29,20 +29,149 @@
 
 #include "video_picture.h"
 
+/* decoded pictures kept per object, the shown one included */
+#define PICTURE_CACHE_SIZE 4
+
 typedef struct _Smart_Data Smart_Data;
+typedef struct _Picture Picture;
+
+struct _Picture
+{
+    Smart_Data *sd;
+    const char *file;
+    Evas_Object *img;
+    Eina_Bool ready;
+};
 
 struct _Smart_Data
 {
     Evas_Coord x, y, w, h;
     Evas_Object *o_edje;
-    Evas_Object *o_img;
+    Evas_Object *o_img;   /* theme group, not cached */
+    Eina_List *cache;     /* Picture, most recently used first */
+    Picture *current;
+    Picture *pending;     /* waited for to replace current */
 };
 
+static void
+_picture_free(Picture *p)
+{
+    /* deleting the object cancels its preload */
+    ENNA_OBJECT_DEL(p->img);
+    eina_stringshare_del(p->file);
+    free(p);
+}
+
+static void
+_picture_show(Smart_Data *sd, Picture *p)
+{
+    if (sd->current && sd->current != p)
+    {
+        edje_object_part_unswallow(sd->o_edje, sd->current->img);
+        evas_object_hide(sd->current->img);
+    }
+    ENNA_OBJECT_DEL(sd->o_img);
+
+    sd->current = p;
+    edje_object_part_swallow(sd->o_edje, "content.swallow", p->img);
+    edje_object_signal_emit(sd->o_edje, "snapshot,show", "enna");
+    evas_object_show(p->img);
+}
+
+static void
+_picture_preloaded_cb(void *data, Evas *e EINA_UNUSED, Evas_Object *obj EINA_UNUSED, void *event_info EINA_UNUSED)
+{
+    Picture *p = data;
+    Smart_Data *sd = p->sd;
+
+    p->ready = EINA_TRUE;
+    if (sd->pending != p)
+        return;
+
+    sd->pending = NULL;
+    _picture_show(sd, p);
+}
+
+/* Drop the least recently used pictures that are neither shown nor
+ * waited for */
+static void
+_cache_trim(Smart_Data *sd)
+{
+    Eina_List *l, *l_prev;
+    Picture *p;
+
+    if (eina_list_count(sd->cache) <= PICTURE_CACHE_SIZE)
+        return;
+
+    EINA_LIST_REVERSE_FOREACH_SAFE(sd->cache, l, l_prev, p)
+    {
+        if (p == sd->current || p == sd->pending)
+            continue;
+        sd->cache = eina_list_remove_list(sd->cache, l);
+        _picture_free(p);
+        if (eina_list_count(sd->cache) <= PICTURE_CACHE_SIZE)
+            break;
+    }
+}
+
+/* Pictures are decoded at the size of the object, or of the screen while
+ * the object has no size yet */
+static void
+_load_size_get(Smart_Data *sd, Evas_Coord *w, Evas_Coord *h)
+{
+    evas_object_geometry_get(sd->o_edje, NULL, NULL, w, h);
+    if (*w <= 0 || *h <= 0)
+        evas_object_geometry_get(enna->layout, NULL, NULL, w, h);
+}
+
+static Picture *
+_picture_get(Smart_Data *sd, const char *file)
+{
+    Eina_List *l;
+    Picture *p;
+    Evas_Coord w, h;
+    Evas_Object *img;
+
+    EINA_LIST_FOREACH(sd->cache, l, p)
+        if (!strcmp(p->file, file))
+        {
+            sd->cache = eina_list_promote_list(sd->cache, l);
+            return p;
+        }
+
+    p = ENNA_NEW(Picture, 1);
+    if (!p)
+        return NULL;
+
+    p->sd = sd;
+    p->file = eina_stringshare_add(file);
+    p->img = elm_icon_add(sd->o_edje);
+
+    img = elm_image_object_get(p->img);
+    _load_size_get(sd, &w, &h);
+    if (w > 0 && h > 0)
+        evas_object_image_load_size_set(img, w, h);
+    evas_object_event_callback_add(img, EVAS_CALLBACK_IMAGE_PRELOADED,
+                                   _picture_preloaded_cb, p);
+    elm_image_file_set(p->img, file, NULL);
+    elm_image_preload_disabled_set(p->img, EINA_FALSE);
+    evas_object_hide(p->img);
+
+    sd->cache = eina_list_prepend(sd->cache, p);
+    _cache_trim(sd);
+
+    return p;
+}
+
 static void
 _del(void *data, Evas *a EINA_UNUSED, Evas_Object *obj EINA_UNUSED, void *event_info EINA_UNUSED)
 {
     Smart_Data *sd = data;
+    Picture *p;
+
     ENNA_OBJECT_DEL(sd->o_img);
+    EINA_LIST_FREE(sd->cache, p)
+        _picture_free(p);
     ENNA_FREE(sd);
 }
 
@@ -67,12 +196,18 @@ enna_video_picture_add(Evas * evas)
     return sd->o_edje;
 }
 
+/*
+ * Files are decoded asynchronously and downscaled: the previous picture
+ * stays until the new one is ready, a newer request replaces the pending
+ * one and recently shown pictures come back without any decoding.
+ */
 void
 enna_video_picture_set (Evas_Object *obj, const char *file, int from_vfs)
 {
-    Evas_Object *o_img_old;
-
     Smart_Data *sd = evas_object_data_get(obj, "sd");
+    Picture *p;
+
+    sd->pending = NULL;
 
     if (!file)
     {
@@ -83,23 +218,44 @@ enna_video_picture_set (Evas_Object *obj, const char *file, int from_vfs)
 
     enna_log(ENNA_MSG_EVENT, "video_picture",
              "using snapshot filename: %s", file);
-    o_img_old = sd->o_img;
 
-    if (from_vfs)
+    if (!from_vfs)
     {
-      sd->o_img = elm_icon_add(sd->o_edje);
-      elm_image_file_set(sd->o_img, file, NULL);
+        if (sd->current)
+        {
+            edje_object_part_unswallow(sd->o_edje, sd->current->img);
+            evas_object_hide(sd->current->img);
+            sd->current = NULL;
+        }
+        ENNA_OBJECT_DEL(sd->o_img);
+        sd->o_img = edje_object_add(evas_object_evas_get(sd->o_edje));
+        edje_object_file_set(sd->o_img, enna_config_theme_get(), file);
+        edje_object_part_swallow(sd->o_edje,
+                                 "content.swallow", sd->o_img);
+        edje_object_signal_emit(sd->o_edje, "snapshot,show", "enna");
+        evas_object_show(sd->o_img);
+        return;
     }
+
+    p = _picture_get(sd, file);
+    if (!p)
+        return;
+
+    if (p->ready)
+        _picture_show(sd, p);
     else
-    {
-      sd->o_img = edje_object_add(evas_object_evas_get(sd->o_edje));
-      edje_object_file_set(sd->o_img, enna_config_theme_get(), file);
-    }
-    edje_object_part_swallow(sd->o_edje,
-                             "content.swallow", sd->o_img);
-    edje_object_signal_emit(sd->o_edje, "snapshot,show", "enna");
-    evas_object_del(o_img_old);
-    evas_object_show(sd->o_img);
+        sd->pending = p;
+}
+
+void
+enna_video_picture_prefetch(Evas_Object *obj, const char *file)
+{
+    Smart_Data *sd = evas_object_data_get(obj, "sd");
+
+    if (!file)
+        return;
+
+    _picture_get(sd, file);
 }
 
 void
@@ -107,6 +263,7 @@ enna_video_picture_unset (Evas_Object *obj)
 {
     Smart_Data *sd = evas_object_data_get(obj, "sd");
 
+    sd->pending = NULL;
     edje_object_signal_emit(sd->o_edje, "snapshot,hide", "enna");
 
     return;
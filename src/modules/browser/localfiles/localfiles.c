@@ -41,6 +41,7 @@
 #include "logs.h"
 #include "utils.h"
 #include "buffer.h"
+#include "trace.h"
 
 #define ENNA_MODULE_NAME "localfiles"
 
@@ -258,13 +259,13 @@ _add_child_volume_cb(void *data, Enna_Volume *v)
     Enna_Browser *b = data;
     Enna_File *f;
 
-    Enna_Buffer *buf;
+    Enna_Buffer buf;
 
-    buf = enna_buffer_new();
-    enna_buffer_appendf(buf, "/%s/localfiles/%s", "music", v->label);
-    f = enna_file_menu_add(v->label, buf->buf,
+    enna_buffer_init(&buf);
+    enna_buffer_appendf(&buf, "/%s/localfiles/%s", "music", v->label);
+    f = enna_file_menu_add(v->label, buf.buf,
                            v->label, "icon/hd");
-    enna_buffer_free(buf);
+    enna_buffer_release(&buf);
     enna_browser_file_add(b, f);
 }
 
@@ -424,7 +425,7 @@ static Enna_File_Meta_Class root_meta_class = {
 };
 
 static void
-_get_children(void *priv, Eina_List *tokens, Enna_Browser *browser, ENNA_VFS_CAPS caps)
+_browse_children(Eina_List *tokens, Enna_Browser *browser, ENNA_VFS_CAPS caps)
 {
     Eina_List *l;
     Class_Private_Data *pmod = NULL;
@@ -460,18 +461,18 @@ _get_children(void *priv, Eina_List *tokens, Enna_Browser *browser, ENNA_VFS_CAP
         {
             Enna_File *f;
             Root_Directories *root;
-            Enna_Buffer *buf;
+            Enna_Buffer buf;
 
             root = l->data;
 
-            buf = enna_buffer_new();
+            enna_buffer_init(&buf);
             EVT("Root name : %s\n", root->name);
-            enna_buffer_appendf(buf, "/%s/localfiles/%s", pmod->name, root->name);
-            f = enna_file_volume_add(root->name, buf->buf,
+            enna_buffer_appendf(&buf, "/%s/localfiles/%s", pmod->name, root->name);
+            f = enna_file_volume_add(root->name, buf.buf,
                                      root->label, root->icon);
 
             enna_file_meta_add(f, &root_meta_class, root);
-            enna_buffer_free(buf);
+            enna_buffer_release(&buf);
             enna_browser_file_add(browser, f);
             /* add localfiles to the list of volumes listener */
         }
@@ -493,16 +494,20 @@ _get_children(void *priv, Eina_List *tokens, Enna_Browser *browser, ENNA_VFS_CAP
                 char *filename = NULL;
                 Eina_List *files_list = NULL;
                 Eina_List *dirs_list = NULL;
-                Enna_Buffer *path;
-                Enna_Buffer *relative_path;
+                Enna_Buffer path;
+                Enna_Buffer relative_path;
+                Enna_Buffer uri;
+                Enna_Buffer mrl;
+                Enna_File_Dir *parent;
+                const char *rel;
                 char *tmp;
                 char dir[PATH_MAX];
                 Eina_List *l_tmp;
+                Enna_File_Arena *arena;
 
-
-                path = enna_buffer_new();
-                relative_path = enna_buffer_new();
-                enna_buffer_appendf(path, "%s", root->uri + 7);
+                enna_buffer_init(&path);
+                enna_buffer_init(&relative_path);
+                enna_buffer_appendf(&path, "%s", root->uri + 7);
                 /* Remove the Root Name (1st Item) from the list received */
                // DBG("Tokens : %d\n", eina_list_count(p->tokens));
                // EINA_LIST_FOREACH(p->tokens, l, tmp)
@@ -511,69 +516,65 @@ _get_children(void *priv, Eina_List *tokens, Enna_Browser *browser, ENNA_VFS_CAP
                 l_tmp = eina_list_nth_list(tokens, 3);
                 EINA_LIST_FOREACH(l_tmp, l, tmp)
                 {
-                    //DBG("Append : /%s to %s\n", tmp, path->buf);
-                    enna_buffer_appendf(path, "/%s", tmp);
-                    enna_buffer_appendf(relative_path, "%s/", tmp);
+                    //DBG("Append : /%s to %s\n", tmp, path.buf);
+                    enna_buffer_appendf(&path, "/%s", tmp);
+                    enna_buffer_appendf(&relative_path, "%s/", tmp);
                 }
-                files = ecore_file_ls(path->buf);
+                files = ecore_file_ls(path.buf);
 
                 /* If no file found return immediatly*/
                 if (!files)
                 {
-                    enna_buffer_free(path);
+                    enna_buffer_release(&path);
+                    enna_buffer_release(&relative_path);
                     return;
                 }
                 files = eina_list_sort(files, eina_list_count(files),
                                        EINA_COMPARE_CB(strcasecmp));
+
+                enna_buffer_init(&uri);
+                enna_buffer_init(&mrl);
+                rel = relative_path.buf ? relative_path.buf : "";
+                /* entries only keep their name, their uri and mrl are
+                 * built from these prefixes when first needed */
+                enna_buffer_appendf(&uri, "/%s/localfiles/%s/%s",
+                                    pmod->name, root->name, rel);
+                /* TODO : remove file:// on top of root->uri */
+                enna_buffer_appendf(&mrl, "%s/%s", root->uri, rel);
+                parent = enna_file_dir_new(uri.buf, mrl.buf);
+                /* the listing entries all go away with the browser */
+                arena = enna_browser_arena_get(browser);
+
                 EINA_LIST_FREE(files, filename)
                 {
-                    sprintf(dir, "%s/%s", path->buf, filename);
+                    snprintf(dir, sizeof(dir), "%s/%s", path.buf, filename);
                     if (filename[0] == '.')
                         continue;
                     else if (ecore_file_is_dir(dir))
                     {
                         Enna_File *f;
-                        Enna_Buffer *buf;
 
-                        buf = enna_buffer_new();
-                        relative_path->buf ?
-                            enna_buffer_appendf(buf, "/%s/localfiles/%s/%s%s", pmod->name, root->name, relative_path->buf, filename) :
-                            enna_buffer_appendf(buf, "/%s/localfiles/%s/%s", pmod->name, root->name, filename);
-
-                        f = enna_file_directory_add(filename, buf->buf, filename, "icon/directory");
-                        enna_buffer_free(buf);
+                        f = enna_file_child_add(arena, parent,
+                                                ENNA_FILE_DIRECTORY, filename,
+                                                filename, "icon/directory");
                         dirs_list = eina_list_append(dirs_list, f);
                     }
                     else if (enna_util_uri_has_extension(dir, caps))
                     {
-                        Enna_Buffer *buf;
-                        Enna_Buffer *mrl;
                         Enna_File *f;
 
-                        buf = enna_buffer_new();
-                        relative_path->buf ?
-                            enna_buffer_appendf(buf, "/%s/localfiles/%s/%s%s", pmod->name, root->name, relative_path->buf, filename) :
-                            enna_buffer_appendf(buf, "/%s/localfiles/%s/%s", pmod->name, root->name, filename);
-
-                        mrl = enna_buffer_new();
-                        /* TODO : remove file:// on top of root->uri */
-                        relative_path->buf ?
-                            enna_buffer_appendf(mrl, "%s/%s%s", root->uri, relative_path->buf, filename):
-                            enna_buffer_appendf(mrl, "%s/%s", root->uri, filename);
                         if (caps == ENNA_CAPS_MUSIC)
-                            f = enna_file_track_add(filename, buf->buf,
-                                                    mrl->buf, filename,
-                                                    "icon/music");
+                            f = enna_file_child_add(arena, parent,
+                                                    ENNA_FILE_TRACK, filename,
+                                                    filename, "icon/music");
                         else if (caps == ENNA_CAPS_VIDEO)
-                            f = enna_file_film_add(filename, buf->buf,
-                                                    mrl->buf, filename,
-                                                    "icon/video");
+                            f = enna_file_child_add(arena, parent,
+                                                    ENNA_FILE_FILM, filename,
+                                                    filename, "icon/video");
                         else
-                            f = enna_file_file_add(filename, buf->buf,
-                                                   mrl->buf, filename,
-                                                   "icon/music");
-                        enna_buffer_free(mrl);
-                        enna_buffer_free(buf);
+                            f = enna_file_child_add(arena, parent,
+                                                    ENNA_FILE_FILE, filename,
+                                                    filename, "icon/music");
 
                         files_list = eina_list_append(files_list, f);
                     }
@@ -590,8 +591,11 @@ _get_children(void *priv, Eina_List *tokens, Enna_Browser *browser, ENNA_VFS_CAP
                     EINA_LIST_FREE(dirs_list, f)
                         enna_browser_file_add(browser, f);
                 }
-                enna_buffer_free(path);
-                enna_buffer_free(relative_path);
+                enna_file_dir_unref(parent);
+                enna_buffer_release(&uri);
+                enna_buffer_release(&mrl);
+                enna_buffer_release(&path);
+                enna_buffer_release(&relative_path);
                 return;
             }
         }
@@ -599,6 +603,15 @@ _get_children(void *priv, Eina_List *tokens, Enna_Browser *browser, ENNA_VFS_CAP
     return;
 }
 
+static void
+_get_children(void *priv EINA_UNUSED, Eina_List *tokens,
+              Enna_Browser *browser, ENNA_VFS_CAPS caps)
+{
+    ENNA_TRACE_BEGIN("localfiles/get_children");
+    _browse_children(tokens, browser, caps);
+    ENNA_TRACE_END("localfiles/get_children");
+}
+
 static void
 _del(void *priv)
 {
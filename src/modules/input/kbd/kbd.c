@@ -19,6 +19,8 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include <string.h>
+
 #include <Ecore.h>
 
 #include "enna.h"
@@ -205,6 +207,18 @@ static const struct
 
 
 static Ecore_Event_Handler *key_down_event_handler;
+static Ecore_Event_Handler *key_up_event_handler;
+
+/* Last key pressed, to tell the auto-repeats from new presses: the key is
+ * either still down, or X sent a release with the very same time stamp
+ * right before the repeated press. */
+static struct
+{
+    const char *keyname;        /* stringshare */
+    Eina_Bool down;
+    unsigned int up_timestamp;
+    double offset;              /* ecore time minus server time, in s */
+} held = { NULL, EINA_FALSE, 0, 0.0 };
 
 static enna_input
 _input_event_modifier (Ecore_Event_Key *ev)
@@ -266,17 +280,43 @@ static Eina_Bool
 _ecore_event_key_down_cb(void *data EINA_UNUSED, int type EINA_UNUSED, void *event)
 {
     Ecore_Event_Key *e = event;
-    enna_input in;
+    Enna_Input_Event ev;
+    Eina_Bool repeat;
 
     enna_idle_timer_renew();
 
-    in = _get_input_from_event(e);
-    if (in != ENNA_INPUT_UNKNOWN)
-        enna_input_event_emit(in);
+    repeat = held.keyname && e->keyname && !strcmp(held.keyname, e->keyname) &&
+        (held.down || held.up_timestamp == e->timestamp);
+    if (!repeat)
+    {
+        eina_stringshare_replace(&held.keyname, e->keyname);
+        held.offset = ecore_time_get() - e->timestamp / 1000.0;
+    }
+    held.down = EINA_TRUE;
+
+    ev.input = _get_input_from_event(e);
+    ev.repeat = repeat;
+    ev.timestamp = held.offset + e->timestamp / 1000.0;
+    if (ev.input != ENNA_INPUT_UNKNOWN)
+        enna_input_event_emit_full(&ev);
 
     return ECORE_CALLBACK_CANCEL;
 }
 
+static Eina_Bool
+_ecore_event_key_up_cb(void *data EINA_UNUSED, int type EINA_UNUSED, void *event)
+{
+    Ecore_Event_Key *e = event;
+
+    if (held.keyname && e->keyname && !strcmp(held.keyname, e->keyname))
+    {
+        held.down = EINA_FALSE;
+        held.up_timestamp = e->timestamp;
+    }
+
+    return ECORE_CALLBACK_PASS_ON;
+}
+
 
 /* Module interface */
 
@@ -290,12 +330,16 @@ module_init(Enna_Module *em EINA_UNUSED)
 {
     key_down_event_handler =
         ecore_event_handler_add (ECORE_EVENT_KEY_DOWN, _ecore_event_key_down_cb, NULL);
+    key_up_event_handler =
+        ecore_event_handler_add (ECORE_EVENT_KEY_UP, _ecore_event_key_up_cb, NULL);
 }
 
 static void
 module_shutdown(Enna_Module *em EINA_UNUSED)
 {
     ENNA_EVENT_HANDLER_DEL(key_down_event_handler);
+    ENNA_EVENT_HANDLER_DEL(key_up_event_handler);
+    ENNA_STRINGSHARE_DEL(held.keyname);
 }
 
 Enna_Module_Api ENNA_MODULE_API =
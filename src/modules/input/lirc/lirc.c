@@ -19,6 +19,9 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
 #include <unistd.h>
 #include <fcntl.h>
 
@@ -35,14 +38,27 @@
 
 #define ENNA_MODULE_NAME "input_lirc"
 
+/* open addressing is not needed: the seed is chosen at init so that no two
+ * key names share a slot, a lookup is one hash and one strcmp */
+#define LIRC_KEYMAP_SIZE 1024
+#define LIRC_KEYMAP_MASK (LIRC_KEYMAP_SIZE - 1)
+#define LIRC_SEED_MAX    65536
+#define LIRC_BATCH_MAX   64
+/* interval between the repeated frames of a held button, about the same
+ * for the RC-5 and NEC protocols */
+#define LIRC_REPEAT_PERIOD 0.11
+
 
 typedef struct _Enna_Module_Lirc Enna_Module_Lirc;
 
 struct _Enna_Module_Lirc
 {
     Enna_Module *em;
+    int fd;
     Ecore_Fd_Handler *fd_handler;
     struct lirc_config *lirc_config;
+    uint32_t keymap_seed;
+    short keymap[LIRC_KEYMAP_SIZE]; /* index in enna_lircmap, -1 if free */
 };
 
 static Enna_Module_Lirc *mod;
@@ -168,39 +184,125 @@ static const struct
 };
 
 
+static uint32_t
+_keymap_hash(uint32_t seed, const char *str)
+{
+    uint32_t h = 2166136261U ^ seed;
+
+    for (; *str; str++)
+    {
+        h ^= (unsigned char) *str;
+        h *= 16777619U;
+    }
+
+    return h ^ (h >> 16);
+}
+
+/* Look for a seed giving each key name its own slot */
+static Eina_Bool
+_keymap_build(void)
+{
+    uint32_t seed;
+    int i, slot;
+
+    for (seed = 0; seed < LIRC_SEED_MAX; seed++)
+    {
+        memset(mod->keymap, 0xff, sizeof(mod->keymap));
+
+        for (i = 0; enna_lircmap[i].keyname; i++)
+        {
+            slot = _keymap_hash(seed, enna_lircmap[i].keyname) & LIRC_KEYMAP_MASK;
+            if (mod->keymap[slot] >= 0)
+                break;
+            mod->keymap[slot] = i;
+        }
+
+        if (!enna_lircmap[i].keyname)
+        {
+            mod->keymap_seed = seed;
+            return EINA_TRUE;
+        }
+    }
+
+    return EINA_FALSE;
+}
+
 static enna_input
 _get_input_from_event(const char *ev)
 {
     int i;
 
-    for (i = 0; enna_lircmap[i].keyname; i++)
-    {
-        if (!strcmp(enna_lircmap[i].keyname, ev))
-          return enna_lircmap[i].input;
-    }
+    i = mod->keymap[_keymap_hash(mod->keymap_seed, ev) & LIRC_KEYMAP_MASK];
+    if (i >= 0 && !strcmp(enna_lircmap[i].keyname, ev))
+        return enna_lircmap[i].input;
 
     enna_log(ENNA_MSG_WARNING, NULL, "Unrecognized lirc key: '%s'", ev);
     // TODO here we could print a list of recognized keys
     return ENNA_INPUT_UNKNOWN;
 }
 
+/* The codes carry no time: those of a held button waiting in the socket
+ * are aged by the repeats of the same button received after them, so
+ * that the input queue can drop what the UI is too late for. */
+static void
+_batch_emit(Enna_Input_Event *batch, unsigned int count, double now)
+{
+    double age = 0.0;
+    unsigned int i;
+
+    for (i = count; i-- > 0;)
+    {
+        if (i + 1 < count && batch[i + 1].repeat &&
+            batch[i + 1].input == batch[i].input)
+            age += LIRC_REPEAT_PERIOD;
+        else
+            age = 0.0;
+        batch[i].timestamp = now - age;
+    }
+
+    enna_input_events_emit(batch, count);
+}
+
+/* Everything lircd has sent so far is read in one go (the socket is non
+ * blocking) and handed to the input queue as one batch. */
 static Eina_Bool _lirc_code_received(void *data, Ecore_Fd_Handler * fd_handler)
 {
+    Enna_Input_Event batch[LIRC_BATCH_MAX];
+    unsigned int count = 0;
+    double now = ecore_time_get();
     char *code, *event;
-    int ret = -1;
 
     while (lirc_nextcode(&code) == 0 && code != NULL)
     {
-        while ((ret = lirc_code2char(mod->lirc_config, code, &event)) == 0
-                && event != NULL)
+        unsigned int rep = 0;
+
+        /* "<scancode> <repeat counter> <button> <remote>" */
+        sscanf(code, "%*llx %x", &rep);
+
+        while (lirc_code2char(mod->lirc_config, code, &event) == 0
+               && event != NULL)
         {
             enna_input in;
 
             in = _get_input_from_event(event);
-            if (in != ENNA_INPUT_UNKNOWN)
-                enna_input_event_emit(in);
+            if (in == ENNA_INPUT_UNKNOWN)
+                continue;
+
+            if (count == LIRC_BATCH_MAX)
+            {
+                _batch_emit(batch, count, now);
+                count = 0;
+            }
+            batch[count].input = in;
+            batch[count].repeat = rep > 0;
+            count++;
         }
+        free(code);
     }
+
+    if (count)
+        _batch_emit(batch, count, now);
+
     return 1;
 }
 
@@ -234,8 +336,9 @@ lirc_panel_hide(void *data)
 #define MOD_PREFIX enna_mod_input_lirc
 #endif /* USE_STATIC_MODULES */
 
+/* Socket connection and config parsing, run on a worker thread */
 static void
-module_init(Enna_Module *em)
+module_init_thread(Enna_Module *em)
 {
     struct lirc_config *config;
     int fd;
@@ -245,6 +348,7 @@ module_init(Enna_Module *em)
     mod = calloc(1, sizeof(Enna_Module_Lirc));
     if (!mod) return;
     mod->em = em;
+    mod->fd = -1;
     em->mod = mod;
 
     // initialize lirc
@@ -263,10 +367,27 @@ module_init(Enna_Module *em)
     }
     mod->lirc_config = config;
 
-    // connect to the lirc socket
+    if (!_keymap_build())
+    {
+        lirc_freeconfig(config);
+        lirc_deinit();
+        enna_log(ENNA_MSG_ERROR, ENNA_MODULE_NAME,
+                "could not build the key map");
+        return;
+    }
+
     fcntl(fd, F_SETFL, O_NONBLOCK);
     fcntl(fd, F_SETFD, FD_CLOEXEC);
-    mod->fd_handler = ecore_main_fd_handler_add(fd, ECORE_FD_READ,
+    mod->fd = fd;
+}
+
+static void
+module_init(Enna_Module *em EINA_UNUSED)
+{
+    if (!mod || mod->fd < 0) return;
+
+    // connect to the lirc socket
+    mod->fd_handler = ecore_main_fd_handler_add(mod->fd, ECORE_FD_READ,
             _lirc_code_received, NULL, NULL, NULL);
 
 #if 0
@@ -300,6 +421,7 @@ Enna_Module_Api ENNA_MODULE_API =
     "bla bla bla<br><b>bla bla bla</b><br><br>bla.",
     {
         module_init,
-        module_shutdown
+        module_shutdown,
+        module_init_thread
     }
 };
@@ -20,6 +20,7 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <mntent.h>
 
@@ -39,7 +40,17 @@ typedef enum {
     MTAB_TYPE_SMB,
 } MTAB_TYPE;
 
+typedef struct _Mtab_Entry Mtab_Entry;
+struct _Mtab_Entry
+{
+    Mtab_Entry *next;
+    MTAB_TYPE type;
+    char *fsname;
+    char *dir;
+};
+
 static Eina_List *_mount_points = NULL;
+static Mtab_Entry *_entries = NULL; /* parsed on a worker, added in main loop */
 
 /***************************************/
 /*           mtab handling             */
@@ -109,10 +120,12 @@ mtab_add_mnt(MTAB_TYPE t, char *fsname, char *dir)
     enna_volumes_add_emit(v);
 }
 
+/* No EFL call in there, it runs on a worker thread */
 static void
 mtab_parse(void)
 {
     struct mntent *mnt;
+    Mtab_Entry **last = &_entries;
     FILE *fp;
 
     fp = fopen(MTAB_FILE, "r");
@@ -122,6 +135,7 @@ mtab_parse(void)
     while((mnt = getmntent(fp)))
     {
         MTAB_TYPE type = MTAB_TYPE_NONE;
+        Mtab_Entry *e;
 
         if(!strcmp(mnt->mnt_type, "nfs") ||
             !strcmp(mnt->mnt_type, "nfs4"))
@@ -132,7 +146,14 @@ mtab_parse(void)
         else
             continue;
 
-        mtab_add_mnt(type, mnt->mnt_fsname, mnt->mnt_dir);
+        e = calloc(1, sizeof(Mtab_Entry));
+        if (!e)
+            break;
+        e->type   = type;
+        e->fsname = strdup(mnt->mnt_fsname);
+        e->dir    = strdup(mnt->mnt_dir);
+        *last = e;
+        last = &e->next;
     }
 
     endmntent(fp);
@@ -146,11 +167,29 @@ mtab_parse(void)
 #endif /* USE_STATIC_MODULES */
 
 static void
-module_init(Enna_Module *em EINA_UNUSED)
+module_init_thread(Enna_Module *em EINA_UNUSED)
 {
     mtab_parse();
 }
 
+static void
+module_init(Enna_Module *em EINA_UNUSED)
+{
+    Mtab_Entry *e;
+
+    while ((e = _entries))
+    {
+        _entries = e->next;
+        mtab_add_mnt(e->type, e->fsname, e->dir);
+        free(e->fsname);
+        free(e->dir);
+        free(e);
+    }
+}
+
+/* volumes are announced to the browsers once they listen */
+static const char *module_deps[] = { "browser_localfiles", NULL };
+
 static void
 module_shutdown(Enna_Module *em EINA_UNUSED)
 {
@@ -176,6 +215,8 @@ Enna_Module_Api ENNA_MODULE_API =
     "bla bla bla<br><b>bla bla bla</b><br><br>bla.",
     {
         module_init,
-        module_shutdown
-    }
+        module_shutdown,
+        module_init_thread
+    },
+    module_deps
 };